@@ -522,6 +522,48 @@ void Application::renderDebugOverlay() {
         ImGui::Text("Sneaking: %s", m_Player->isSneaking() ? "Yes" : "No");
         ImGui::Text("Render Distance: %d", m_World->m_RenderDistance);
         ImGui::Text("Chunks Rendered: %d / %llu", m_RenderedChunks, m_World->getChunkCount());
+        ImGui::Text("Chunks Generating: %llu", m_World->getPendingGenerationCount());
+        ChunkStageCounts stageCounts = m_World->getStageCounts();
+        std::string stages;
+        for (int i = 0; i < CHUNK_STATUS_COUNT; ++i) {
+            if (stageCounts[i] == 0) continue;
+            if (!stages.empty()) stages += ", ";
+            stages += getChunkStatusName(static_cast<ChunkStatus>(i)) + std::string(" ") + std::to_string(stageCounts[i]);
+        }
+        ImGui::Text("Chunk Stages: %s", stages.empty() ? "-" : stages.c_str());
+        LightScheduler::Stats lightStats = m_World->getLightingStats();
+        ImGui::Text("Lighting: %llu workers, %.0f%% busy, %.1f jobs/s, %llu queued, %llu running",
+            lightStats.workers, 100.0 * lightStats.busyFraction, lightStats.jobsPerSecond, lightStats.queued, lightStats.running);
+        ImGui::Text("Light Edits: %llu in %llu batches", lightStats.updateJobs, lightStats.updateBatches);
+        ImGui::Text("Light Queues: %.2f M nodes/s, %llu allocations", lightStats.nodesPerSecond / 1000000.0, lightStats.queueAllocations);
+        ColumnCache::Stats columnStats = m_World->getTerrainGenerator().getColumnCacheStats();
+        size_t columnLookups = columnStats.hits + columnStats.misses;
+        ImGui::Text("Column Cache: %.1f%% hits (%llu / %llu), %llu / %llu columns",
+            columnLookups > 0 ? 100.0 * columnStats.hits / columnLookups : 0.0,
+            columnStats.hits, columnLookups, columnStats.columns, columnStats.capacity);
+        size_t chunkCount = m_World->getChunkCount();
+        size_t chunkMemory = m_World->getChunkMemoryUsage();
+        const size_t denseChunkBytes = 2 * CHUNK_VOLUME;
+        ImGui::Text("Chunk Memory: %.1f MB (%.1f KB/chunk, dense %.1f KB/chunk)",
+            chunkMemory / (1024.0 * 1024.0),
+            chunkCount > 0 ? chunkMemory / 1024.0 / chunkCount : 0.0,
+            denseChunkBytes / 1024.0);
+        WorldMemoryUsage usage = m_World->getMemoryUsage();
+        const double MB = 1024.0 * 1024.0;
+        ImGui::Text("World Memory: %.1f MB (blocks %.1f, light %.1f, snapshots %.1f)",
+            usage.total() / MB, usage.blocks / MB, usage.light / MB, usage.snapshots / MB);
+        ImGui::Text("Mesh Memory: %.1f MB CPU, %.1f MB GPU, %.1f MB GPU pooled",
+            usage.meshCpu / MB, usage.meshGpu / MB, usage.pooledMeshGpu / MB);
+        if (m_World->m_MemoryBudget > 0) {
+            ImGui::Text("Memory Budget: %.0f MB, load radius %.1f, %llu chunks evicted",
+                m_World->m_MemoryBudget / MB, m_World->getBudgetLoadRadius(), m_World->getEvictedChunkCount());
+        }
+        ImGui::Text("Pending Reclaim: %llu", m_World->getPendingReclaimCount());
+        ChunkPool::Stats poolStats = m_World->getChunkPoolStats();
+        ImGui::Text("Chunk Pool: %llu hits / %llu misses (%llu free, %.1f MB storage)", poolStats.chunkHits, poolStats.chunkMisses, poolStats.freeChunks, poolStats.freeStorageBytes / MB);
+        ImGui::Text("Light Pool: %llu hits / %llu misses (%llu free)", poolStats.lightHits, poolStats.lightMisses, poolStats.freeLight);
+        ImGui::Text("Mesh Pool: %llu hits / %llu misses (%llu free)", poolStats.meshHits, poolStats.meshMisses, poolStats.freeMeshes);
+        ImGui::Text("Mesh Jobs Skipped: %llu superseded, %llu stale", m_World->getSupersededMeshJobCount(), m_World->getStaleMeshCount());
         ImGui::Text("Mesher: %s", (m_World->m_UseGreedyMesher && !m_World->m_SmoothLighting) ? "Greedy" : "Simple");
     }
     ImGui::End();
@@ -562,6 +604,10 @@ void Application::renderImGui() {
             m_World->forceReload();
         }
 
+        if (ImGui::SliderInt("Memory Budget (MB, 0 = none)", &m_MemoryBudgetMB, 0, 4096)) {
+            m_World->m_MemoryBudget = static_cast<size_t>(m_MemoryBudgetMB) * 1024 * 1024;
+        }
+
         if (ImGui::Checkbox("Sunlight", &m_World->m_UseSunlight)) {
             m_World->forceReload();
         }
@@ -588,6 +634,12 @@ void Application::renderImGui() {
             m_World->forceReload();
         }
 
+        const char* samplingItems[] = { "Full", "Coarse Lattice" };
+        int currentSampling = m_World->getTerrainGenerator().getLatticeSpacing() == NoiseLatticeSpacing::full() ? 0 : 1;
+        if (ImGui::Combo("Terrain Sampling", &currentSampling, samplingItems, IM_ARRAYSIZE(samplingItems))) {
+            m_World->setTerrainLattice(currentSampling == 0 ? NoiseLatticeSpacing::full() : NoiseLatticeSpacing::coarse());
+        }
+
 
         ImGui::Separator();
         bool isFlying = m_Player->isFlying();
@@ -761,25 +813,21 @@ void Application::findSpawnPosition() {
     float spawnZ = 8.5f;
 
     int spawnY = CHUNK_HEIGHT - 1;
-    for (int y = CHUNK_HEIGHT - 1; y >= 0; --y) {
-        if (m_World->getBlock((int)spawnX, y, (int)spawnZ) != 0) {
-            spawnY = y + 2;
-            break;
+    int height = m_World->getHeight((int)spawnX, (int)spawnZ);
+    if (height > 0) {
+        // Leaves let sunlight through, so climb out of any canopy above the height.
+        while (height < CHUNK_HEIGHT - 2 && m_World->getBlock((int)spawnX, height, (int)spawnZ) != 0) {
+            height++;
         }
+        spawnY = height + 1;
     }
 
     if (spawnY == CHUNK_HEIGHT - 1) {
-        FastNoiseLite noise;
-        noise.SetSeed(1337);
-        noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        noise.SetFrequency(0.005f);
-        noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-        noise.SetFractalOctaves(5);
-        noise.SetFractalLacunarity(2.0f);
-        noise.SetFractalGain(0.5f);
-
-        float noiseValue = noise.GetNoise(spawnX, spawnZ);
-        spawnY = 64 + static_cast<int>(((noiseValue + 1.0f) / 2.0f) * (CHUNK_HEIGHT - 70));
+        // Not loaded yet: ask the generator, which shares its cached columns with chunk generation.
+        TerrainColumn column = m_World->getTerrainGenerator().getColumn((int)spawnX, (int)spawnZ);
+        int surface = column.height;
+        if (surface < TerrainGenerator::WATER_LEVEL) surface = TerrainGenerator::WATER_LEVEL;
+        spawnY = surface + 2;
     }
 
     glm::vec3 spawnPos(spawnX, spawnY, spawnZ);
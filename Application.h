@@ -58,6 +58,7 @@ private:
     bool m_WireframeMode = false;
     bool m_ShowDebugOverlay = true;
     int m_MipmapLevel = 4;
+    int m_MemoryBudgetMB = 0;
     float m_DeltaTime = 0.0f;
     float m_LastFrame = 0.0f;
     int m_RenderedChunks = 0;
@@ -1,70 +1,547 @@
 #include "Chunk.h"
+#include "Block.h"
+#include "ChunkPool.h"
 #include "Mesh.h"
+#include <algorithm>
 #include <cstring>
 
-Chunk::Chunk(int x, int y, int z) : m_Position(x, y, z) {
+const char* getChunkStatusName(ChunkStatus status) {
+    switch (status) {
+    case ChunkStatus::Empty: return "Empty";
+    case ChunkStatus::Decorated: return "Decorated";
+    case ChunkStatus::Lighting: return "Lighting";
+    case ChunkStatus::Lit: return "Lit";
+    case ChunkStatus::Meshing: return "Meshing";
+    case ChunkStatus::Meshed: return "Meshed";
+    case ChunkStatus::Uploaded: return "Uploaded";
+    }
+    return "Unknown";
+}
+
+template<typename Layout>
+BasicChunk<Layout>::BasicChunk(int x, int y, int z) : m_Position(x, y, z) {
     m_Mesh = std::make_unique<Mesh>();
     m_TransparentMesh = std::make_unique<Mesh>();
+    for (auto& section : m_Sections) {
+        section.blocks.store(new PalettedStorage(SECTION_VOLUME), std::memory_order_relaxed);
+    }
+}
+
+template<typename Layout>
+BasicChunk<Layout>::BasicChunk(int x, int y, int z, ChunkPool& pool, std::unique_ptr<Mesh> mesh, std::unique_ptr<Mesh> transparentMesh, SectionBlocks blocks)
+    : m_Position(x, y, z), m_Mesh(std::move(mesh)), m_TransparentMesh(std::move(transparentMesh)), m_Pool(&pool) {
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        if (blocks[sy]) {
+            blocks[sy]->clear(0);
+        }
+        else {
+            blocks[sy] = std::make_unique<PalettedStorage>(SECTION_VOLUME);
+        }
+        m_Sections[sy].blocks.store(blocks[sy].release(), std::memory_order_relaxed);
+    }
 }
 
-void Chunk::drawOpaque() {
+template<typename Layout>
+BasicChunk<Layout>::~BasicChunk() = default;
+
+template<typename Layout>
+void BasicChunk<Layout>::releaseStorage(SectionBlocks& blocks, SectionLight& light) {
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        blocks[sy].reset(m_Sections[sy].blocks.exchange(nullptr, std::memory_order_relaxed));
+        light[sy].reset(m_Sections[sy].light.exchange(nullptr, std::memory_order_relaxed));
+    }
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::drawOpaque() {
     if (m_Mesh) {
         m_Mesh->draw();
     }
 }
 
-void Chunk::drawTransparent() {
+template<typename Layout>
+void BasicChunk<Layout>::drawTransparent() {
     if (m_TransparentMesh) {
         m_TransparentMesh->draw();
     }
 }
 
-unsigned char Chunk::getBlock(int x, int y, int z) const {
+template<typename Layout>
+unsigned char BasicChunk<Layout>::getBlock(int x, int y, int z) const {
     if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
         return 0;
     }
-    return blocks[x][y][z];
+    return m_Sections[y / SECTION_HEIGHT].getBlocks().get(Section::getIndex(x, y % SECTION_HEIGHT, z));
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::setBlock(int x, int y, int z, unsigned char blockID) {
+    if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
+        return;
+    }
+    m_Sections[y / SECTION_HEIGHT].blocks.load()->set(Section::getIndex(x, y % SECTION_HEIGHT, z), blockID);
+    updateHeight(x, y, z, blockID);
+    markChanged(sectionBit(y));
 }
 
-void Chunk::setBlock(int x, int y, int z, unsigned char blockID) {
+template<typename Layout>
+std::unique_ptr<PalettedStorage> BasicChunk<Layout>::setBlockCopyOnWrite(int x, int y, int z, unsigned char blockID) {
     if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
+        return nullptr;
+    }
+    Section& section = m_Sections[y / SECTION_HEIGHT];
+    PalettedStorage* current = section.blocks.load(std::memory_order_acquire);
+    auto edited = std::make_unique<PalettedStorage>(*current);
+    edited->set(Section::getIndex(x, y % SECTION_HEIGHT, z), blockID);
+    section.blocks.store(edited.release(), std::memory_order_release);
+    updateHeight(x, y, z, blockID);
+    markChanged(sectionBit(y));
+    return std::unique_ptr<PalettedStorage>(current);
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::updateHeight(int x, int y, int z, unsigned char blockID) {
+    std::atomic<uint8_t>& height = m_Heights[x * CHUNK_DEPTH + z];
+    if (!BlockDataManager::isTransparentForLighting(static_cast<BlockID>(blockID))) {
+        if (y >= height.load(std::memory_order_relaxed)) {
+            height.store(static_cast<uint8_t>(y + 1), std::memory_order_release);
+        }
         return;
     }
-    blocks[x][y][z] = blockID;
+    if (y + 1 != height.load(std::memory_order_relaxed)) return;
+    // The top blocker went away; the next one down is the new top.
+    int top = y;
+    while (top > 0 && BlockDataManager::isTransparentForLighting(static_cast<BlockID>(getBlock(x, top - 1, z)))) {
+        --top;
+    }
+    height.store(static_cast<uint8_t>(top), std::memory_order_release);
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::computeHeight(int x, int z, const unsigned char* column, int stride) {
+    int top = CHUNK_HEIGHT;
+    while (top > 0 && BlockDataManager::isTransparentForLighting(static_cast<BlockID>(column[(top - 1) * stride]))) {
+        --top;
+    }
+    m_Heights[x * CHUNK_DEPTH + z].store(static_cast<uint8_t>(top), std::memory_order_release);
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::getBlocks(unsigned char* out) const {
+    unsigned char sectionBlocks[SECTION_VOLUME];
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        const PalettedStorage& blocks = m_Sections[sy].getBlocks();
+        if (blocks.isUniform()) {
+            for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                std::memset(out + getIndex(x, sy * SECTION_HEIGHT, 0), blocks.get(0), SECTION_HEIGHT * CHUNK_DEPTH);
+            }
+            continue;
+        }
+        blocks.decode(sectionBlocks);
+        copySectionToDense(sectionBlocks, out + getIndex(0, sy * SECTION_HEIGHT, 0));
+    }
 }
 
-void Chunk::setBlocks(const unsigned char* data) {
-    std::memcpy(blocks, data, sizeof(blocks));
+template<typename Layout>
+void BasicChunk<Layout>::getBlocks(unsigned char* out, int x0, int x1, int y0, int y1, int z0, int z1) const {
+    for (int sy = y0 / SECTION_HEIGHT; sy * SECTION_HEIGHT < y1; ++sy) {
+        const PalettedStorage& blocks = m_Sections[sy].getBlocks();
+        const int sectionY0 = std::max(y0 - sy * SECTION_HEIGHT, 0);
+        const int sectionY1 = std::min(y1 - sy * SECTION_HEIGHT, SECTION_HEIGHT);
+        // Decoding the whole section is cheaper than looking up most of it voxel by voxel.
+        if (!blocks.isUniform() && (x1 - x0) * (sectionY1 - sectionY0) * (z1 - z0) * 4 >= SECTION_VOLUME) {
+            unsigned char sectionBlocks[SECTION_VOLUME];
+            blocks.decode(sectionBlocks);
+            copySectionRows(sectionBlocks, out, sy, x0, x1, sectionY0, sectionY1, z0, z1);
+            continue;
+        }
+        for (int x = x0; x < x1; ++x) {
+            for (int y = sectionY0; y < sectionY1; ++y) {
+                unsigned char* row = out + getIndex(x, sy * SECTION_HEIGHT + y, 0);
+                if (blocks.isUniform()) {
+                    std::memset(row + z0, blocks.get(0), z1 - z0);
+                    continue;
+                }
+                for (int z = z0; z < z1; ++z) {
+                    row[z] = blocks.get(Section::getIndex(x, y, z));
+                }
+            }
+        }
+    }
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::setBlocks(const unsigned char* data) {
+    unsigned char sectionBlocks[SECTION_VOLUME];
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        copyDenseToSection(data + getIndex(0, sy * SECTION_HEIGHT, 0), sectionBlocks);
+        m_Sections[sy].blocks.load()->encode(sectionBlocks);
+    }
+    for (int x = 0; x < CHUNK_WIDTH; ++x) {
+        for (int z = 0; z < CHUNK_DEPTH; ++z) {
+            computeHeight(x, z, data + getIndex(x, 0, z), CHUNK_DEPTH);
+        }
+    }
+    markChanged(ALL_SECTIONS);
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::setColumns(const ChunkColumns& columns) {
+    unsigned char sectionBlocks[SECTION_VOLUME];
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                const unsigned char* column = columns.getColumn(x, z) + sy * SECTION_HEIGHT;
+                if constexpr (Layout::MATCHES_COLUMN_ORDER) {
+                    std::memcpy(sectionBlocks + Section::getIndex(x, 0, z), column, SECTION_HEIGHT);
+                }
+                else {
+                    for (int y = 0; y < SECTION_HEIGHT; ++y) {
+                        sectionBlocks[Section::getIndex(x, y, z)] = column[y];
+                    }
+                }
+            }
+        }
+        m_Sections[sy].blocks.load()->encode(sectionBlocks);
+    }
+    for (int x = 0; x < CHUNK_WIDTH; ++x) {
+        for (int z = 0; z < CHUNK_DEPTH; ++z) {
+            computeHeight(x, z, columns.getColumn(x, z), 1);
+        }
+    }
+    markChanged(ALL_SECTIONS);
+}
+
+template<typename Layout>
+bool BasicChunk<Layout>::isSectionEmpty(int sectionY) const {
+    unsigned char blockID;
+    return isSectionUniform(sectionY, blockID) && blockID == 0;
+}
+
+template<typename Layout>
+bool BasicChunk<Layout>::isSectionUniform(int sectionY, unsigned char& blockID) const {
+    const PalettedStorage& blocks = m_Sections[sectionY].getBlocks();
+    if (!blocks.isUniform()) return false;
+    blockID = blocks.get(0);
+    return true;
 }
 
-unsigned char Chunk::getSunlight(int x, int y, int z) const {
+template<typename Layout>
+size_t BasicChunk<Layout>::getBlockMemoryUsage() const {
+    size_t total = 0;
+    for (const auto& section : m_Sections) {
+        total += section.getBlocks().getMemoryUsage();
+    }
+    return total;
+}
+
+template<typename Layout>
+unsigned char BasicChunk<Layout>::getSunlight(int x, int y, int z) const {
     if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
         return 15;
     }
-    return lightLevels[x][y][z] >> 4;
+    const unsigned char* light = m_Sections[y / SECTION_HEIGHT].light.load(std::memory_order_acquire);
+    if (!light) return IMPLICIT_SECTION_LIGHT >> 4;
+    return light[Section::getIndex(x, y % SECTION_HEIGHT, z)] >> 4;
 }
 
-void Chunk::setSunlight(int x, int y, int z, unsigned char lightLevel) {
+template<typename Layout>
+void BasicChunk<Layout>::setSunlight(int x, int y, int z, unsigned char lightLevel) {
     if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
         return;
     }
-    lightLevels[x][y][z] = (lightLevels[x][y][z] & 0x0F) | (lightLevel << 4);
+    Section& section = m_Sections[y / SECTION_HEIGHT];
+    unsigned char* light = section.light.load(std::memory_order_acquire);
+    if (!light) {
+        if (lightLevel == (IMPLICIT_SECTION_LIGHT >> 4)) return;
+        light = materializeLight(section);
+    }
+    unsigned char& packed = light[Section::getIndex(x, y % SECTION_HEIGHT, z)];
+    unsigned char updated = (packed & 0x0F) | (lightLevel << 4);
+    if (packed == updated) return;
+    packed = updated;
+    markLightChanged(sectionBit(y));
 }
 
-unsigned char Chunk::getBlockLight(int x, int y, int z) const {
+template<typename Layout>
+unsigned char BasicChunk<Layout>::getBlockLight(int x, int y, int z) const {
     if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
         return 0;
     }
-    return lightLevels[x][y][z] & 0x0F;
+    const unsigned char* light = m_Sections[y / SECTION_HEIGHT].light.load(std::memory_order_acquire);
+    if (!light) return IMPLICIT_SECTION_LIGHT & 0x0F;
+    return light[Section::getIndex(x, y % SECTION_HEIGHT, z)] & 0x0F;
 }
 
-void Chunk::setBlockLight(int x, int y, int z, unsigned char lightLevel) {
+template<typename Layout>
+void BasicChunk<Layout>::setBlockLight(int x, int y, int z, unsigned char lightLevel) {
     if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
         return;
     }
-    lightLevels[x][y][z] = (lightLevels[x][y][z] & 0xF0) | lightLevel;
+    Section& section = m_Sections[y / SECTION_HEIGHT];
+    unsigned char* light = section.light.load(std::memory_order_acquire);
+    if (!light) {
+        if (lightLevel == (IMPLICIT_SECTION_LIGHT & 0x0F)) return;
+        light = materializeLight(section);
+    }
+    unsigned char& packed = light[Section::getIndex(x, y % SECTION_HEIGHT, z)];
+    unsigned char updated = (packed & 0xF0) | lightLevel;
+    if (packed == updated) return;
+    packed = updated;
+    markLightChanged(sectionBit(y));
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::getLightLevels(unsigned char* out) const {
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        const unsigned char* light = m_Sections[sy].light.load(std::memory_order_acquire);
+        if (!light) {
+            for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                std::memset(out + getIndex(x, sy * SECTION_HEIGHT, 0), IMPLICIT_SECTION_LIGHT, SECTION_HEIGHT * CHUNK_DEPTH);
+            }
+            continue;
+        }
+        copySectionToDense(light, out + getIndex(0, sy * SECTION_HEIGHT, 0));
+    }
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::getLightLevels(unsigned char* out, int x0, int x1, int y0, int y1, int z0, int z1) const {
+    for (int sy = y0 / SECTION_HEIGHT; sy * SECTION_HEIGHT < y1; ++sy) {
+        const unsigned char* light = m_Sections[sy].light.load(std::memory_order_acquire);
+        const int sectionY0 = std::max(y0 - sy * SECTION_HEIGHT, 0);
+        const int sectionY1 = std::min(y1 - sy * SECTION_HEIGHT, SECTION_HEIGHT);
+        if (light) {
+            copySectionRows(light, out, sy, x0, x1, sectionY0, sectionY1, z0, z1);
+            continue;
+        }
+        for (int x = x0; x < x1; ++x) {
+            for (int y = sectionY0; y < sectionY1; ++y) {
+                std::memset(out + getIndex(x, sy * SECTION_HEIGHT + y, z0), IMPLICIT_SECTION_LIGHT, z1 - z0);
+            }
+        }
+    }
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::setLightLevels(const unsigned char* data) {
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        Section& section = m_Sections[sy];
+        const unsigned char* sectionData = data + getIndex(0, sy * SECTION_HEIGHT, 0);
+        unsigned char* light = section.light.load(std::memory_order_acquire);
+        if (!light) {
+            bool implicit = true;
+            for (int x = 0; x < CHUNK_WIDTH && implicit; ++x) {
+                const unsigned char* column = sectionData + getIndex(x, 0, 0);
+                for (int i = 0; i < SECTION_HEIGHT * CHUNK_DEPTH && implicit; ++i) {
+                    implicit = column[i] == IMPLICIT_SECTION_LIGHT;
+                }
+            }
+            if (implicit) continue;
+            light = materializeLight(section);
+        }
+        copyDenseToSection(sectionData, light);
+    }
+    markChanged(ALL_SECTIONS);
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::fillSectionLight(int sectionY, unsigned char sunlight, unsigned char blockLight) {
+    unsigned char packed = (sunlight << 4) | blockLight;
+    Section& section = m_Sections[sectionY];
+    unsigned char* light = section.light.load(std::memory_order_acquire);
+    if (!light) {
+        if (packed == IMPLICIT_SECTION_LIGHT) return;
+        light = materializeLight(section);
+    }
+    // A materialised section keeps its array: another thread may be reading it right now.
+    std::memset(light, packed, SECTION_VOLUME);
+    markChanged(1u << sectionY);
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::publishSnapshot() {
+    uint32_t changed = m_ChangedSections.exchange(0, std::memory_order_acq_rel);
+    std::shared_ptr<const Snapshot> previous = std::atomic_load(&m_Snapshot);
+    if (previous && changed == 0) return;
+    // Light writes leave the version alone (see markLightChanged), so it moves here.
+    uint32_t version = m_Version.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+    auto snapshot = previous ? std::make_shared<Snapshot>(*previous) : std::make_shared<Snapshot>();
+    snapshot->version = version;
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        if (previous && !(changed & (1u << sy))) continue;
+        const Section& section = m_Sections[sy];
+        snapshot->blocks[sy] = std::make_shared<const PalettedStorage>(section.getBlocks());
+        const unsigned char* light = section.light.load(std::memory_order_acquire);
+        if (light) {
+            std::shared_ptr<unsigned char[]> copy(new unsigned char[SECTION_VOLUME]);
+            std::memcpy(copy.get(), light, SECTION_VOLUME);
+            snapshot->light[sy] = std::move(copy);
+        }
+        else {
+            snapshot->light[sy].reset();
+        }
+    }
+    std::atomic_store(&m_Snapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+}
+
+template<typename Layout>
+size_t BasicChunk<Layout>::getLightMemoryUsage() const {
+    return static_cast<size_t>(getLightSectionCount()) * SECTION_VOLUME;
+}
+
+template<typename Layout>
+int BasicChunk<Layout>::getLightSectionCount() const {
+    int count = 0;
+    for (const auto& section : m_Sections) {
+        if (section.light.load(std::memory_order_relaxed)) count++;
+    }
+    return count;
+}
+
+template<typename Layout>
+unsigned char* BasicChunk<Layout>::materializeLight(Section& section) {
+    std::unique_ptr<unsigned char[]> light = m_Pool ? m_Pool->acquireLight() : std::unique_ptr<unsigned char[]>(new unsigned char[SECTION_VOLUME]);
+    std::memset(light.get(), IMPLICIT_SECTION_LIGHT, SECTION_VOLUME);
+    unsigned char* expected = nullptr;
+    if (!section.light.compare_exchange_strong(expected, light.get(), std::memory_order_acq_rel)) {
+        if (m_Pool) m_Pool->releaseLight(std::move(light));
+        return expected;
+    }
+    return light.release();
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::copySectionToDense(const unsigned char* section, unsigned char* dense) {
+    for (int x = 0; x < CHUNK_WIDTH; ++x) {
+        unsigned char* column = dense + getIndex(x, 0, 0);
+        if constexpr (Layout::MATCHES_DENSE_ORDER) {
+            std::memcpy(column, section + Section::getIndex(x, 0, 0), SECTION_HEIGHT * CHUNK_DEPTH);
+        }
+        else {
+            for (int y = 0; y < SECTION_HEIGHT; ++y) {
+                for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                    column[y * CHUNK_DEPTH + z] = section[Section::getIndex(x, y, z)];
+                }
+            }
+        }
+    }
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::copyDenseToSection(const unsigned char* dense, unsigned char* section) {
+    for (int x = 0; x < CHUNK_WIDTH; ++x) {
+        const unsigned char* column = dense + getIndex(x, 0, 0);
+        if constexpr (Layout::MATCHES_DENSE_ORDER) {
+            std::memcpy(section + Section::getIndex(x, 0, 0), column, SECTION_HEIGHT * CHUNK_DEPTH);
+        }
+        else {
+            for (int y = 0; y < SECTION_HEIGHT; ++y) {
+                for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                    section[Section::getIndex(x, y, z)] = column[y * CHUNK_DEPTH + z];
+                }
+            }
+        }
+    }
+}
+
+template<typename Layout>
+void BasicChunk<Layout>::copySectionRows(const unsigned char* section, unsigned char* dense, int sectionY, int x0, int x1, int y0, int y1, int z0, int z1) {
+    for (int x = x0; x < x1; ++x) {
+        for (int y = y0; y < y1; ++y) {
+            unsigned char* row = dense + getIndex(x, sectionY * SECTION_HEIGHT + y, 0);
+            if constexpr (Layout::MATCHES_DENSE_ORDER) {
+                std::memcpy(row + z0, section + Section::getIndex(x, y, z0), z1 - z0);
+            }
+            else {
+                for (int z = z0; z < z1; ++z) {
+                    row[z] = section[Section::getIndex(x, y, z)];
+                }
+            }
+        }
+    }
+}
+
+template<typename Layout>
+unsigned char BasicChunkSnapshot<Layout>::getBlock(int x, int y, int z) const {
+    if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
+        return 0;
+    }
+    return blocks[y / SECTION_HEIGHT]->get(Section::getIndex(x, y % SECTION_HEIGHT, z));
+}
+
+template<typename Layout>
+unsigned char BasicChunkSnapshot<Layout>::getSunlight(int x, int y, int z) const {
+    if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
+        return 15;
+    }
+    const unsigned char* sectionLight = light[y / SECTION_HEIGHT].get();
+    if (!sectionLight) return IMPLICIT_SECTION_LIGHT >> 4;
+    return sectionLight[Section::getIndex(x, y % SECTION_HEIGHT, z)] >> 4;
+}
+
+template<typename Layout>
+unsigned char BasicChunkSnapshot<Layout>::getBlockLight(int x, int y, int z) const {
+    if (x < 0 || x >= CHUNK_WIDTH || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_DEPTH) {
+        return 0;
+    }
+    const unsigned char* sectionLight = light[y / SECTION_HEIGHT].get();
+    if (!sectionLight) return IMPLICIT_SECTION_LIGHT & 0x0F;
+    return sectionLight[Section::getIndex(x, y % SECTION_HEIGHT, z)] & 0x0F;
+}
+
+template<typename Layout>
+void BasicChunkSnapshot<Layout>::getBlocks(unsigned char* out) const {
+    unsigned char sectionBlocks[SECTION_VOLUME];
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        const PalettedStorage& storage = *blocks[sy];
+        if (storage.isUniform()) {
+            for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                std::memset(out + getIndex(x, sy * SECTION_HEIGHT, 0), storage.get(0), SECTION_HEIGHT * CHUNK_DEPTH);
+            }
+            continue;
+        }
+        storage.decode(sectionBlocks);
+        BasicChunk<Layout>::copySectionToDense(sectionBlocks, out + getIndex(0, sy * SECTION_HEIGHT, 0));
+    }
+}
+
+template<typename Layout>
+void BasicChunkSnapshot<Layout>::getLightLevels(unsigned char* out) const {
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        if (!light[sy]) {
+            for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                std::memset(out + getIndex(x, sy * SECTION_HEIGHT, 0), IMPLICIT_SECTION_LIGHT, SECTION_HEIGHT * CHUNK_DEPTH);
+            }
+            continue;
+        }
+        BasicChunk<Layout>::copySectionToDense(light[sy].get(), out + getIndex(0, sy * SECTION_HEIGHT, 0));
+    }
 }
 
-void Chunk::setLightLevels(const unsigned char* data) {
-    std::memcpy(lightLevels, data, sizeof(lightLevels));
-}
\ No newline at end of file
+template<typename Layout>
+bool BasicChunkSnapshot<Layout>::isSectionEmpty(int sectionY) const {
+    const PalettedStorage& storage = *blocks[sectionY];
+    return storage.isUniform() && storage.get(0) == 0;
+}
+
+template<typename Layout>
+size_t BasicChunkSnapshot<Layout>::getMemoryUsage() const {
+    size_t total = 0;
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        total += blocks[sy]->getMemoryUsage();
+        if (light[sy]) total += SECTION_VOLUME;
+    }
+    return total;
+}
+
+template class BasicChunk<XYZLayout>;
+template class BasicChunk<YXZLayout>;
+template class BasicChunk<XZYLayout>;
+template class BasicChunk<MortonLayout>;
+
+template struct BasicChunkSnapshot<XYZLayout>;
+template struct BasicChunkSnapshot<YXZLayout>;
+template struct BasicChunkSnapshot<XZYLayout>;
+template struct BasicChunkSnapshot<MortonLayout>;
\ No newline at end of file
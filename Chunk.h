@@ -1,33 +1,160 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <vector>
 #include <memory>
-#include <glad/glad.h>
 #include <glm/glm.hpp>
+#include "PalettedStorage.h"
+#include "VoxelLayout.h"
 
 struct Mesh;
+class ChunkPool;
 
 const int CHUNK_WIDTH = 16;
 const int CHUNK_HEIGHT = 128;
 const int CHUNK_DEPTH = 16;
+const int CHUNK_VOLUME = CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_DEPTH;
 
-class Chunk {
+// World to chunk coordinates with shifts and masks: x >> CHUNK_WIDTH_SHIFT floors for
+// negative x too, and x & CHUNK_WIDTH_MASK is the matching local coordinate.
+const int CHUNK_WIDTH_SHIFT = 4;
+const int CHUNK_DEPTH_SHIFT = 4;
+const int CHUNK_WIDTH_MASK = CHUNK_WIDTH - 1;
+const int CHUNK_DEPTH_MASK = CHUNK_DEPTH - 1;
+static_assert((1 << CHUNK_WIDTH_SHIFT) == CHUNK_WIDTH && (1 << CHUNK_DEPTH_SHIFT) == CHUNK_DEPTH, "chunk width and depth must match their shifts");
+
+const int SECTION_HEIGHT = 16;
+const int SECTION_COUNT = CHUNK_HEIGHT / SECTION_HEIGHT;
+const int SECTION_VOLUME = CHUNK_WIDTH * SECTION_HEIGHT * CHUNK_DEPTH;
+
+// Packed light value (sunlight << 4 | block light) of a section with no light storage.
+const unsigned char IMPLICIT_SECTION_LIGHT = 15 << 4;
+
+// Per-section block storage and SECTION_VOLUME-byte light arrays of one chunk, as handed
+// between a chunk and ChunkPool.
+using SectionBlocks = std::array<std::unique_ptr<PalettedStorage>, SECTION_COUNT>;
+using SectionLight = std::array<std::unique_ptr<unsigned char[]>, SECTION_COUNT>;
+
+// A 16x16x16 slice of a column. A section made of a single block (open sky, solid stone)
+// collapses to a one-entry palette with no index array behind it.
+// Block storage is read without locks; once a chunk is shared, edits replace the whole
+// storage (see Chunk::setBlockCopyOnWrite) instead of repacking it under a reader.
+// Light is allocated on the first write that differs from IMPLICIT_SECTION_LIGHT, so open
+// sky above the terrain costs nothing. The chunk constructor sets the block storage.
+template<typename Layout>
+struct BasicChunkSection {
+    std::atomic<PalettedStorage*> blocks{ nullptr };
+    std::atomic<unsigned char*> light{ nullptr };
+
+    BasicChunkSection() = default;
+    ~BasicChunkSection() {
+        delete blocks.load();
+        delete[] light.load();
+    }
+    BasicChunkSection(const BasicChunkSection&) = delete;
+    BasicChunkSection& operator=(const BasicChunkSection&) = delete;
+
+    const PalettedStorage& getBlocks() const { return *blocks.load(std::memory_order_acquire); }
+
+    static int getIndex(int x, int y, int z) { return Layout::getIndex(x, y, z); }
+};
+
+template<typename Layout>
+struct BasicChunkSnapshot;
+
+// How far a chunk has come through the loading pipeline, in stage order. Chunks reach the
+// world at Decorated; a later stage only starts once the loaded neighbours it reads have
+// reached the stage before it.
+enum class ChunkStatus : uint8_t {
+    Empty,     // allocated, nothing generated yet
+    Decorated, // generated: terrain, trees and bedrock placed
+    Lighting,  // initial lighting queued or running
+    Lit,
+    Meshing,   // first mesh queued or being built
+    Meshed,    // first mesh built, waiting for upload
+    Uploaded,
+};
+
+const int CHUNK_STATUS_COUNT = static_cast<int>(ChunkStatus::Uploaded) + 1;
+
+const char* getChunkStatusName(ChunkStatus status);
+
+// Blocks of one chunk with each (x, z) column's blocks contiguous, so a vertical run is a
+// single memset. Generation writes whole runs here and hands the result to
+// BasicChunk::setColumns, which encodes every section once instead of repacking palettes
+// voxel by voxel.
+class ChunkColumns {
+public:
+    ChunkColumns() : m_Blocks(CHUNK_VOLUME, 0) {}
+
+    // Sets blocks y0..y1 (inclusive) of column (x, z); the part outside the chunk is dropped.
+    void fill(int x, int z, int y0, int y1, unsigned char blockID) {
+        if (x < 0 || x >= CHUNK_WIDTH || z < 0 || z >= CHUNK_DEPTH) return;
+        if (y0 < 0) y0 = 0;
+        if (y1 >= CHUNK_HEIGHT) y1 = CHUNK_HEIGHT - 1;
+        if (y0 > y1) return;
+        std::memset(&m_Blocks[getIndex(x, y0, z)], blockID, y1 - y0 + 1);
+    }
+
+    unsigned char get(int x, int y, int z) const { return m_Blocks[getIndex(x, y, z)]; }
+    void set(int x, int y, int z, unsigned char blockID) { m_Blocks[getIndex(x, y, z)] = blockID; }
+
+    // CHUNK_HEIGHT blocks of column (x, z), bottom first.
+    const unsigned char* getColumn(int x, int z) const { return &m_Blocks[getIndex(x, 0, z)]; }
+
+    static int getIndex(int x, int y, int z) { return (x * CHUNK_DEPTH + z) * CHUNK_HEIGHT + y; }
+
+private:
+    std::vector<unsigned char> m_Blocks;
+};
+
+// A 16x128x16 column of blocks and light. Layout sets the voxel order inside each section;
+// the game uses Chunk (VOXEL_LAYOUT), and other instantiations exist for benchmarking.
+template<typename Layout>
+class BasicChunk {
 public:
+    using Section = BasicChunkSection<Layout>;
+    using Snapshot = BasicChunkSnapshot<Layout>;
+
     const glm::ivec3 m_Position;
     std::unique_ptr<Mesh> m_Mesh;
     std::unique_ptr<Mesh> m_TransparentMesh;
-    unsigned char blocks[CHUNK_WIDTH][CHUNK_HEIGHT][CHUNK_DEPTH] = { 0 };
-    bool m_HasBeenMeshed = false;
+    std::atomic<ChunkStatus> m_Status{ ChunkStatus::Empty };
+    // Id of the newest meshing job queued for this chunk; older queued jobs are superseded.
+    std::atomic<uint32_t> m_LatestMeshJob{ 0 };
+    // Vertical extent of the non-empty sections the current mesh was built from, for culling.
+    int m_MeshMinY = 0;
+    int m_MeshMaxY = CHUNK_HEIGHT;
 
-    Chunk(int x, int y, int z);
+    BasicChunk(int x, int y, int z);
+    // Takes meshes and section block storage recycled from an unloaded chunk (see ChunkPool);
+    // the storage is cleared to air, and light arrays come from the pool as well.
+    BasicChunk(int x, int y, int z, ChunkPool& pool, std::unique_ptr<Mesh> mesh, std::unique_ptr<Mesh> transparentMesh, SectionBlocks blocks);
+    ~BasicChunk();
+
+    // Moves every section's block storage and light array out for ChunkPool to reuse. Only
+    // for a chunk about to be destroyed.
+    void releaseStorage(SectionBlocks& blocks, SectionLight& light);
 
     void drawOpaque();
     void drawTransparent();
 
     unsigned char getBlock(int x, int y, int z) const;
+    // Edits in place; only for chunks no other thread can see yet (e.g. during generation).
     void setBlock(int x, int y, int z, unsigned char blockID);
+    // Edits a copy of the section's storage and publishes it. The previous storage is
+    // returned so the caller can retire it once no reader can still hold it.
+    std::unique_ptr<PalettedStorage> setBlockCopyOnWrite(int x, int y, int z, unsigned char blockID);
 
-    const unsigned char* getBlocks() const { return &blocks[0][0][0]; }
+    // Bulk decode/encode of the whole column as a dense [x][y][z] array of CHUNK_VOLUME bytes.
+    void getBlocks(unsigned char* out) const;
+    // Decodes only the voxels with x in [x0, x1), y in [y0, y1) and z in [z0, z1) into their
+    // place in out.
+    void getBlocks(unsigned char* out, int x0, int x1, int y0, int y1, int z0, int z1) const;
     void setBlocks(const unsigned char* data);
+    // Replaces every block with the contents of columns; same rules as setBlock.
+    void setColumns(const ChunkColumns& columns);
 
     unsigned char getSunlight(int x, int y, int z) const;
     void setSunlight(int x, int y, int z, unsigned char lightLevel);
@@ -35,9 +162,113 @@ public:
     unsigned char getBlockLight(int x, int y, int z) const;
     void setBlockLight(int x, int y, int z, unsigned char lightLevel);
 
+    // Bulk copy of the packed light (sunlight << 4 | block light) as a dense [x][y][z] array.
+    void getLightLevels(unsigned char* out) const;
+    void getLightLevels(unsigned char* out, int x0, int x1, int y0, int y1, int z0, int z1) const;
     void setLightLevels(const unsigned char* data);
+    void fillSectionLight(int sectionY, unsigned char sunlight, unsigned char blockLight);
+
+    bool isSectionEmpty(int sectionY) const;
+    bool isSectionUniform(int sectionY, unsigned char& blockID) const;
+
+    // One above the highest block in column (x, z) that stops sunlight, 0 if sunlight reaches
+    // the bottom; every voxel from there up is open sky. Kept current by every block write.
+    int getHeight(int x, int z) const { return m_Heights[x * CHUNK_DEPTH + z].load(std::memory_order_acquire); }
+
+    // Content version, bumped after every block change and by every publishSnapshot() that
+    // finds changed sections, so a flood of light writes moves it once.
+    uint32_t getVersion() const { return m_Version.load(std::memory_order_acquire); }
+
+    // The last published snapshot; null until the first publishSnapshot().
+    std::shared_ptr<const Snapshot> getSnapshot() const { return std::atomic_load(&m_Snapshot); }
+    // Publishes a snapshot of the current contents, copying only the sections changed since
+    // the previous one. Only one thread may publish a given chunk: the loader before the
+    // chunk is shared, the lighting thread afterwards.
+    void publishSnapshot();
+
+    size_t getBlockMemoryUsage() const;
+    size_t getLightMemoryUsage() const;
+    int getLightSectionCount() const;
+
+    static int getIndex(int x, int y, int z) { return (x * CHUNK_HEIGHT + y) * CHUNK_DEPTH + z; }
+
+    // Convert one section between Layout order and the dense [x][y][z] chunk order, where
+    // dense points at (0, sectionY * SECTION_HEIGHT, 0) of a CHUNK_VOLUME buffer.
+    static void copySectionToDense(const unsigned char* section, unsigned char* dense);
+    static void copyDenseToSection(const unsigned char* dense, unsigned char* section);
+    // Copies the voxels of section sectionY with x in [x0, x1), section-local y in [y0, y1)
+    // and z in [z0, z1) into their place in a whole dense CHUNK_VOLUME buffer.
+    static void copySectionRows(const unsigned char* section, unsigned char* dense, int sectionY, int x0, int x1, int y0, int y1, int z0, int z1);
 
 private:
-    // 4 bits for sunlight, 4 bits for block light
-    unsigned char lightLevels[CHUNK_WIDTH][CHUNK_HEIGHT][CHUNK_DEPTH] = { 0 };
-};
\ No newline at end of file
+    // Returns the section's light array, allocating it filled with the implicit value if needed.
+    unsigned char* materializeLight(Section& section);
+    // Moves the column's height after blockID was written at (x, y, z).
+    void updateHeight(int x, int y, int z, unsigned char blockID);
+    // Sets the column's height from its CHUNK_HEIGHT blocks, found at column[y * stride].
+    void computeHeight(int x, int z, const unsigned char* column, int stride);
+
+    // Called after a write lands: the section bit is set before the version moves, so a
+    // publisher that sees the new version also sees the section as changed.
+    void markChanged(uint32_t sectionMask) {
+        m_ChangedSections.fetch_or(sectionMask, std::memory_order_release);
+        m_Version.fetch_add(1, std::memory_order_acq_rel);
+    }
+    // Single-voxel light writes sit inside the lighting flood, so they only flag their
+    // section, and skip even that once it is flagged. The thread writing the light is the
+    // one that publishes the chunk afterwards, and publishing moves the version.
+    void markLightChanged(uint32_t sectionMask) {
+        if ((m_ChangedSections.load(std::memory_order_relaxed) & sectionMask) == sectionMask) return;
+        m_ChangedSections.fetch_or(sectionMask, std::memory_order_relaxed);
+    }
+    static uint32_t sectionBit(int y) { return 1u << (y / SECTION_HEIGHT); }
+
+    static const uint32_t ALL_SECTIONS = (1u << SECTION_COUNT) - 1;
+
+    std::array<Section, SECTION_COUNT> m_Sections;
+    // See getHeight; written by the thread editing blocks, read by the lighting threads.
+    std::array<std::atomic<uint8_t>, CHUNK_WIDTH * CHUNK_DEPTH> m_Heights{};
+    std::atomic<uint32_t> m_Version{ 0 };
+    // Sections written since the last publishSnapshot().
+    std::atomic<uint32_t> m_ChangedSections{ 0 };
+    std::shared_ptr<const Snapshot> m_Snapshot;
+    // Source of light arrays; null for chunks made outside a pool.
+    ChunkPool* m_Pool = nullptr;
+};
+
+// Immutable view of a chunk at one version, shared by reference count. Meshers take the 3x3
+// neighbourhood's snapshots instead of reading chunks the lighting thread is writing to.
+// Consecutive snapshots share the storage of every section that didn't change in between.
+template<typename Layout>
+struct BasicChunkSnapshot {
+    using Section = BasicChunkSection<Layout>;
+
+    uint32_t version = 0;
+    std::array<std::shared_ptr<const PalettedStorage>, SECTION_COUNT> blocks;
+    // Packed light in Layout order; null for sections at IMPLICIT_SECTION_LIGHT.
+    std::array<std::shared_ptr<const unsigned char[]>, SECTION_COUNT> light;
+
+    unsigned char getBlock(int x, int y, int z) const;
+    unsigned char getSunlight(int x, int y, int z) const;
+    unsigned char getBlockLight(int x, int y, int z) const;
+    void getBlocks(unsigned char* out) const;
+    void getLightLevels(unsigned char* out) const;
+    bool isSectionEmpty(int sectionY) const;
+    // Counts shared sections in full, so two snapshots of one chunk can overlap.
+    size_t getMemoryUsage() const;
+
+    static int getIndex(int x, int y, int z) { return BasicChunk<Layout>::getIndex(x, y, z); }
+};
+
+using ChunkSection = BasicChunkSection<VOXEL_LAYOUT>;
+using Chunk = BasicChunk<VOXEL_LAYOUT>;
+using ChunkSnapshot = BasicChunkSnapshot<VOXEL_LAYOUT>;
+
+extern template class BasicChunk<XYZLayout>;
+extern template class BasicChunk<YXZLayout>;
+extern template class BasicChunk<XZYLayout>;
+extern template class BasicChunk<MortonLayout>;
+extern template struct BasicChunkSnapshot<XYZLayout>;
+extern template struct BasicChunkSnapshot<YXZLayout>;
+extern template struct BasicChunkSnapshot<XZYLayout>;
+extern template struct BasicChunkSnapshot<MortonLayout>;
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "ChunkPool.h"
+#include "Mesh.h"
+#include <new>
+
+ChunkPool::~ChunkPool() {
+    // Every chunk must have been released by now; only free storage and meshes remain.
+    m_FreeMeshes.clear();
+    m_FreeBlocks.clear();
+    m_FreeLight.clear();
+    m_Slabs.clear();
+}
+
+std::shared_ptr<Chunk> ChunkPool::acquire(int x, int y, int z) {
+    ChunkStorage* storage;
+    std::unique_ptr<Mesh> mesh;
+    std::unique_ptr<Mesh> transparentMesh;
+    SectionBlocks blocks;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_FreeChunks.empty()) {
+            m_Stats.chunkMisses++;
+            m_Slabs.push_back(std::make_unique<ChunkStorage[]>(CHUNKS_PER_SLAB));
+            ChunkStorage* slab = m_Slabs.back().get();
+            for (int i = CHUNKS_PER_SLAB - 1; i >= 0; --i) {
+                m_FreeChunks.push_back(&slab[i]);
+            }
+        }
+        else {
+            m_Stats.chunkHits++;
+        }
+        storage = m_FreeChunks.back();
+        m_FreeChunks.pop_back();
+
+        mesh = acquireMesh();
+        transparentMesh = acquireMesh();
+        if (!m_FreeBlocks.empty()) {
+            blocks = std::move(m_FreeBlocks.back());
+            m_FreeBlocks.pop_back();
+        }
+    }
+
+    Chunk* chunk = new (storage->bytes) Chunk(x, y, z, *this, std::move(mesh), std::move(transparentMesh), std::move(blocks));
+    return std::shared_ptr<Chunk>(chunk, [this](Chunk* released) { release(released); });
+}
+
+std::unique_ptr<unsigned char[]> ChunkPool::acquireLight() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_FreeLight.empty()) {
+            m_Stats.lightHits++;
+            std::unique_ptr<unsigned char[]> light = std::move(m_FreeLight.back());
+            m_FreeLight.pop_back();
+            return light;
+        }
+        m_Stats.lightMisses++;
+    }
+    return std::unique_ptr<unsigned char[]>(new unsigned char[SECTION_VOLUME]);
+}
+
+void ChunkPool::releaseLight(std::unique_ptr<unsigned char[]> light) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeLight.push_back(std::move(light));
+}
+
+ChunkPool::Stats ChunkPool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Stats stats = m_Stats;
+    stats.freeChunks = m_FreeChunks.size();
+    stats.freeMeshes = m_FreeMeshes.size();
+    stats.freeLight = m_FreeLight.size();
+    for (const auto& mesh : m_FreeMeshes) {
+        stats.freeMeshGpuBytes += mesh->gpuBytes;
+    }
+    for (const SectionBlocks& blocks : m_FreeBlocks) {
+        for (const auto& storage : blocks) {
+            stats.freeStorageBytes += storage->getMemoryUsage();
+        }
+    }
+    stats.freeStorageBytes += m_FreeLight.size() * SECTION_VOLUME;
+    return stats;
+}
+
+void ChunkPool::trimFreeMeshes() {
+    std::vector<std::unique_ptr<Mesh>> freed;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    freed.swap(m_FreeMeshes);
+}
+
+void ChunkPool::trimFreeStorage() {
+    std::vector<SectionBlocks> freedBlocks;
+    std::vector<std::unique_ptr<unsigned char[]>> freedLight;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    freedBlocks.swap(m_FreeBlocks);
+    freedLight.swap(m_FreeLight);
+}
+
+void ChunkPool::release(Chunk* chunk) {
+    std::unique_ptr<Mesh> mesh = std::move(chunk->m_Mesh);
+    std::unique_ptr<Mesh> transparentMesh = std::move(chunk->m_TransparentMesh);
+    SectionBlocks blocks;
+    SectionLight light;
+    chunk->releaseStorage(blocks, light);
+    chunk->~Chunk();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeChunks.push_back(reinterpret_cast<ChunkStorage*>(chunk));
+    for (auto* released : { &mesh, &transparentMesh }) {
+        if (!*released) continue;
+        (*released)->clear();
+        m_FreeMeshes.push_back(std::move(*released));
+    }
+    m_FreeBlocks.push_back(std::move(blocks));
+    for (auto& array : light) {
+        if (array) m_FreeLight.push_back(std::move(array));
+    }
+}
+
+std::unique_ptr<Mesh> ChunkPool::acquireMesh() {
+    if (m_FreeMeshes.empty()) {
+        m_Stats.meshMisses++;
+        return std::make_unique<Mesh>();
+    }
+    m_Stats.meshHits++;
+    std::unique_ptr<Mesh> mesh = std::move(m_FreeMeshes.back());
+    m_FreeMeshes.pop_back();
+    return mesh;
+}
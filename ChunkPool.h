@@ -0,0 +1,67 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Chunk.h"
+
+struct Mesh;
+
+// Recycles chunk storage and chunk meshes across load/unload cycles. Chunks come from
+// fixed-size slabs, and unloaded chunks hand their meshes (with their VAO/VBO/EBO), their
+// sections' block storage and their light arrays back to free lists instead of deleting
+// them. A section's storage is reused for the same section of the next chunk, where terrain
+// is likely to need an index array of the same width. The last reference to a pooled chunk
+// must be dropped on the thread that owns the GL context.
+class ChunkPool {
+public:
+    struct Stats {
+        size_t chunkHits = 0;
+        size_t chunkMisses = 0;
+        size_t meshHits = 0;
+        size_t meshMisses = 0;
+        size_t lightHits = 0;
+        size_t lightMisses = 0;
+        size_t freeChunks = 0;
+        size_t freeMeshes = 0;
+        size_t freeLight = 0;
+        // GPU buffer bytes still held by the free meshes.
+        size_t freeMeshGpuBytes = 0;
+        // Block storage and light bytes held by the free lists.
+        size_t freeStorageBytes = 0;
+    };
+
+    ChunkPool() = default;
+    ~ChunkPool();
+
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    std::shared_ptr<Chunk> acquire(int x, int y, int z);
+    // A SECTION_VOLUME-byte light array with undefined contents, for Chunk's sections.
+    std::unique_ptr<unsigned char[]> acquireLight();
+    void releaseLight(std::unique_ptr<unsigned char[]> light);
+
+    Stats getStats() const;
+    // Deletes every free mesh along with its GL objects. Call on the GL thread.
+    void trimFreeMeshes();
+    // Deletes the free block storage and light arrays.
+    void trimFreeStorage();
+
+private:
+    static const int CHUNKS_PER_SLAB = 16;
+
+    struct ChunkStorage {
+        alignas(Chunk) unsigned char bytes[sizeof(Chunk)];
+    };
+
+    void release(Chunk* chunk);
+    std::unique_ptr<Mesh> acquireMesh();
+
+    std::vector<std::unique_ptr<ChunkStorage[]>> m_Slabs;
+    std::vector<ChunkStorage*> m_FreeChunks;
+    std::vector<std::unique_ptr<Mesh>> m_FreeMeshes;
+    std::vector<SectionBlocks> m_FreeBlocks;
+    std::vector<std::unique_ptr<unsigned char[]>> m_FreeLight;
+    Stats m_Stats;
+    mutable std::mutex m_Mutex;
+};
@@ -0,0 +1,60 @@
+#include "ChunkTable.h"
+#include <cstdlib>
+
+ChunkTable::Grid::Grid(int diameter) : diameter(diameter) {
+    size_t count = static_cast<size_t>(diameter) * diameter;
+    slots = std::make_unique<std::atomic<Chunk*>[]>(count);
+    for (size_t i = 0; i < count; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ChunkTable::~ChunkTable() {
+    m_Grid.store(nullptr);
+}
+
+void ChunkTable::reset(int radius) {
+    auto grid = std::make_shared<Grid>(2 * radius + 1);
+    m_Grid.store(grid.get(), std::memory_order_release);
+
+    for (auto& chunk : m_Owned) {
+        m_Reclaimer.retire(std::move(chunk));
+    }
+    m_Reclaimer.retire(std::move(m_GridOwner));
+
+    m_GridOwner = std::move(grid);
+    m_Owned.clear();
+    m_Owned.resize(static_cast<size_t>(m_GridOwner->diameter) * m_GridOwner->diameter);
+    m_Radius = radius;
+    m_Count = 0;
+}
+
+void ChunkTable::clear() {
+    for (size_t slot = 0; slot < m_Owned.size(); ++slot) {
+        if (m_Owned[slot]) retireSlot(slot);
+    }
+}
+
+bool ChunkTable::isInRange(const glm::ivec3& pos) const {
+    return abs(pos.x - m_Center.x) <= m_Radius && abs(pos.z - m_Center.z) <= m_Radius;
+}
+
+void ChunkTable::insert(std::shared_ptr<Chunk> chunk) {
+    size_t slot = m_GridOwner->getSlot(chunk->m_Position.x, chunk->m_Position.z);
+    if (m_Owned[slot]) retireSlot(slot);
+    m_GridOwner->slots[slot].store(chunk.get(), std::memory_order_release);
+    m_Owned[slot] = std::move(chunk);
+    m_Count++;
+}
+
+void ChunkTable::erase(const glm::ivec3& pos) {
+    if (!get(pos.x, pos.z)) return;
+    retireSlot(m_GridOwner->getSlot(pos.x, pos.z));
+}
+
+void ChunkTable::retireSlot(size_t slot) {
+    m_GridOwner->slots[slot].store(nullptr, std::memory_order_release);
+    m_Reclaimer.retire(std::move(m_Owned[slot]));
+    m_Owned[slot].reset();
+    m_Count--;
+}
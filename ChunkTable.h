@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+#include "EpochReclaimer.h"
+
+// Chunk lookup table over the square of loaded columns. Slots are addressed by chunk
+// coordinate modulo the loaded diameter, so a lookup is two modulos and a compare, and the
+// square keeps a one-to-one mapping as the centre moves.
+//
+// get() is safe from any thread registered with the reclaimer and never takes a lock.
+// Everything else is the writer side and belongs to the main thread: removed chunks and
+// replaced slot arrays are retired rather than freed, so a reader that just loaded one
+// keeps a valid pointer until its next quiescent state.
+class ChunkTable {
+public:
+    explicit ChunkTable(EpochReclaimer& reclaimer) : m_Reclaimer(reclaimer) {}
+    ~ChunkTable();
+
+    ChunkTable(const ChunkTable&) = delete;
+    ChunkTable& operator=(const ChunkTable&) = delete;
+
+    Chunk* get(int chunkX, int chunkZ) const {
+        const Grid* grid = m_Grid.load(std::memory_order_acquire);
+        if (!grid) return nullptr;
+        Chunk* chunk = grid->slots[grid->getSlot(chunkX, chunkZ)].load(std::memory_order_acquire);
+        if (chunk && chunk->m_Position.x == chunkX && chunk->m_Position.z == chunkZ) return chunk;
+        return nullptr;
+    }
+
+    void reset(int radius);
+    void clear();
+    void setCenter(const glm::ivec3& center) { m_Center = center; }
+
+    int getRadius() const { return m_Radius; }
+    const glm::ivec3& getCenter() const { return m_Center; }
+    size_t size() const { return m_Count; }
+
+    bool contains(const glm::ivec3& pos) const { return get(pos.x, pos.z) != nullptr; }
+    bool isInRange(const glm::ivec3& pos) const;
+
+    void insert(std::shared_ptr<Chunk> chunk);
+    void erase(const glm::ivec3& pos);
+
+    // Visits loaded chunks in x-major, then z order across the loaded square.
+    template<typename Func>
+    void forEach(Func&& func) const {
+        if (!m_GridOwner) return;
+        for (int x = m_Center.x - m_Radius; x <= m_Center.x + m_Radius; ++x) {
+            for (int z = m_Center.z - m_Radius; z <= m_Center.z + m_Radius; ++z) {
+                const auto& chunk = m_Owned[m_GridOwner->getSlot(x, z)];
+                if (chunk && chunk->m_Position.x == x && chunk->m_Position.z == z) func(*chunk);
+            }
+        }
+    }
+
+private:
+    struct Grid {
+        explicit Grid(int diameter);
+
+        size_t getSlot(int chunkX, int chunkZ) const {
+            int sx = ((chunkX % diameter) + diameter) % diameter;
+            int sz = ((chunkZ % diameter) + diameter) % diameter;
+            return static_cast<size_t>(sx) * diameter + sz;
+        }
+
+        int diameter;
+        std::unique_ptr<std::atomic<Chunk*>[]> slots;
+    };
+
+    void retireSlot(size_t slot);
+
+    EpochReclaimer& m_Reclaimer;
+    std::atomic<const Grid*> m_Grid{ nullptr };
+    std::shared_ptr<Grid> m_GridOwner;
+    std::vector<std::shared_ptr<Chunk>> m_Owned;
+    glm::ivec3 m_Center{ 0 };
+    int m_Radius = 0;
+    size_t m_Count = 0;
+};
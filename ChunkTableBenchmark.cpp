@@ -0,0 +1,115 @@
+#include "ChunkTableBenchmark.h"
+#include "Chunk.h"
+#include "ChunkTable.h"
+#include "EpochReclaimer.h"
+#include "World.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    const int BENCHMARK_RUNS = 5;
+    const int LOOKUPS = 1 << 22;
+    const int ITERATION_PASSES = 64;
+
+    using ChunkMap = std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_comp>;
+
+    struct TableTimings {
+        double mapLookupNs = 1e30;
+        double tableLookupNs = 1e30;
+        double mapIterateNs = 1e30;
+        double tableIterateNs = 1e30;
+        bool matches = true;
+    };
+
+    double elapsedNs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Both containers hold the same chunks, centred on a point away from the origin so the
+    // table's slots wrap as they do after the player has walked a while.
+    TableTimings benchmarkRadius(int radius) {
+        const glm::ivec3 center(1000, 0, -700);
+
+        EpochReclaimer reclaimer;
+        ChunkTable table(reclaimer);
+        table.reset(radius);
+        table.setCenter(center);
+        ChunkMap map;
+        for (int x = center.x - radius; x <= center.x + radius; ++x) {
+            for (int z = center.z - radius; z <= center.z + radius; ++z) {
+                auto chunk = std::make_shared<Chunk>(x, 0, z);
+                map[chunk->m_Position] = chunk;
+                table.insert(std::move(chunk));
+            }
+        }
+
+        std::mt19937 rng(1337);
+        std::uniform_int_distribution<int> offset(-radius, radius);
+        std::vector<glm::ivec3> positions(LOOKUPS);
+        for (glm::ivec3& pos : positions) {
+            pos = glm::ivec3(center.x + offset(rng), 0, center.z + offset(rng));
+        }
+
+        TableTimings best;
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+            long long mapSum = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const glm::ivec3& pos : positions) {
+                auto it = map.find(pos);
+                if (it != map.end()) mapSum += it->second->m_Position.x;
+            }
+            best.mapLookupNs = std::min(best.mapLookupNs, elapsedNs(start) / LOOKUPS);
+
+            long long tableSum = 0;
+            start = std::chrono::steady_clock::now();
+            for (const glm::ivec3& pos : positions) {
+                if (const Chunk* chunk = table.get(pos.x, pos.z)) tableSum += chunk->m_Position.x;
+            }
+            best.tableLookupNs = std::min(best.tableLookupNs, elapsedNs(start) / LOOKUPS);
+
+            long long mapVisits = 0;
+            start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < ITERATION_PASSES; ++pass) {
+                for (const auto& entry : map) mapVisits += entry.second->m_Position.z;
+            }
+            best.mapIterateNs = std::min(best.mapIterateNs, elapsedNs(start) / (ITERATION_PASSES * map.size()));
+
+            long long tableVisits = 0;
+            start = std::chrono::steady_clock::now();
+            for (int pass = 0; pass < ITERATION_PASSES; ++pass) {
+                table.forEach([&](const Chunk& chunk) { tableVisits += chunk.m_Position.z; });
+            }
+            best.tableIterateNs = std::min(best.tableIterateNs, elapsedNs(start) / (ITERATION_PASSES * table.size()));
+
+            best.matches = best.matches && mapSum == tableSum && mapVisits == tableVisits;
+        }
+
+        table.clear();
+        reclaimer.collect();
+        return best;
+    }
+}
+
+int runChunkTableBenchmark() {
+    printf("Best of %d runs, %d random in-range lookups, %d passes over all chunks, ns per chunk\n",
+        BENCHMARK_RUNS, LOOKUPS, ITERATION_PASSES);
+    printf("%-8s %8s %10s %10s %10s %10s\n", "radius", "chunks", "map find", "table get", "map iter", "table iter");
+    bool matches = true;
+    for (int radius : { 8, 16, 32 }) {
+        TableTimings timings = benchmarkRadius(radius);
+        const int diameter = 2 * radius + 1;
+        printf("%-8d %8d %10.1f %10.1f %10.2f %10.2f\n", radius, diameter * diameter,
+            timings.mapLookupNs, timings.tableLookupNs, timings.mapIterateNs, timings.tableIterateNs);
+        matches = matches && timings.matches;
+    }
+    if (!matches) {
+        printf("ChunkTable and std::map disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Fills a ChunkTable and the std::map it replaced with the same chunks at render distances
+// 8, 16 and 32, then prints the cost of random in-range lookups and of visiting every
+// loaded chunk. Returns a process exit code.
+int runChunkTableBenchmark();
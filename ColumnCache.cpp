@@ -0,0 +1,110 @@
+#include "ColumnCache.h"
+
+ColumnCache::ColumnCache(size_t capacity)
+    : m_ShardCapacity((capacity + SHARD_COUNT - 1) / SHARD_COUNT) {
+    if (m_ShardCapacity == 0) m_ShardCapacity = 1;
+}
+
+bool ColumnCache::get(int worldX, int worldZ, TerrainColumn& out) {
+    uint64_t key = makeKey(worldX, worldZ);
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        shard.misses++;
+        return false;
+    }
+
+    shard.hits++;
+    uint32_t slot = it->second;
+    if (shard.head != slot) {
+        unlink(shard, slot);
+        pushFront(shard, slot);
+    }
+    out = shard.entries[slot].column;
+    return true;
+}
+
+void ColumnCache::put(int worldX, int worldZ, const TerrainColumn& column) {
+    uint64_t key = makeKey(worldX, worldZ);
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        // Another thread computed the same column first; the values are identical.
+        return;
+    }
+
+    uint32_t slot;
+    if (shard.entries.size() < m_ShardCapacity) {
+        slot = (uint32_t)shard.entries.size();
+        shard.entries.push_back({});
+    }
+    else {
+        slot = shard.tail;
+        unlink(shard, slot);
+        shard.index.erase(shard.entries[slot].key);
+    }
+
+    shard.entries[slot].key = key;
+    shard.entries[slot].column = column;
+    pushFront(shard, slot);
+    shard.index.emplace(key, slot);
+}
+
+void ColumnCache::clear() {
+    for (Shard& shard : m_Shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.entries.clear();
+        shard.head = NONE;
+        shard.tail = NONE;
+    }
+}
+
+ColumnCache::Stats ColumnCache::getStats() const {
+    Stats stats;
+    stats.capacity = m_ShardCapacity * SHARD_COUNT;
+    for (const Shard& shard : m_Shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.columns += shard.entries.size();
+    }
+    return stats;
+}
+
+size_t ColumnCache::getMemoryUsage() const {
+    size_t total = sizeof(ColumnCache);
+    for (const Shard& shard : m_Shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.entries.capacity() * sizeof(Entry);
+        // Buckets plus one node (key, slot and next pointer) per entry.
+        total += shard.index.bucket_count() * sizeof(void*);
+        total += shard.index.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void*));
+    }
+    return total;
+}
+
+ColumnCache::Shard& ColumnCache::getShard(uint64_t key) {
+    // Neighbouring columns land in different shards, so one chunk's lookups spread out.
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+    return m_Shards[(h >> 60) & (SHARD_COUNT - 1)];
+}
+
+void ColumnCache::unlink(Shard& shard, uint32_t slot) {
+    Entry& entry = shard.entries[slot];
+    if (entry.prev != NONE) shard.entries[entry.prev].next = entry.next;
+    else shard.head = entry.next;
+    if (entry.next != NONE) shard.entries[entry.next].prev = entry.prev;
+    else shard.tail = entry.prev;
+}
+
+void ColumnCache::pushFront(Shard& shard, uint32_t slot) {
+    Entry& entry = shard.entries[slot];
+    entry.prev = NONE;
+    entry.next = shard.head;
+    if (shard.head != NONE) shard.entries[shard.head].prev = slot;
+    shard.head = slot;
+    if (shard.tail == NONE) shard.tail = slot;
+}
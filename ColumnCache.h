@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+enum class Biome {
+    Ocean,
+    Plains,
+    Forest
+};
+
+// Shaped terrain of one world column: the surface block's y and the biome it belongs to.
+struct TerrainColumn {
+    int height;
+    Biome biome;
+};
+
+// LRU cache of TerrainColumns keyed by world x/z, shared by every generator thread. Columns
+// are spread over independently locked shards so concurrent lookups rarely contend.
+class ColumnCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t columns = 0;
+        size_t capacity = 0;
+    };
+
+    explicit ColumnCache(size_t capacity);
+
+    ColumnCache(const ColumnCache&) = delete;
+    ColumnCache& operator=(const ColumnCache&) = delete;
+
+    // Counts a hit or miss; a hit also makes the column the most recently used in its shard.
+    bool get(int worldX, int worldZ, TerrainColumn& out);
+    void put(int worldX, int worldZ, const TerrainColumn& column);
+    void clear();
+
+    Stats getStats() const;
+    size_t getMemoryUsage() const;
+
+private:
+    static const int SHARD_COUNT = 16;
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Entry {
+        uint64_t key;
+        TerrainColumn column;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    // Entries form a doubly linked list from most (head) to least (tail) recently used;
+    // once the shard is full, the tail's slot is reused.
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> index;
+        std::vector<Entry> entries;
+        uint32_t head = NONE;
+        uint32_t tail = NONE;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    static uint64_t makeKey(int worldX, int worldZ) {
+        return ((uint64_t)(uint32_t)worldX << 32) | (uint32_t)worldZ;
+    }
+
+    Shard& getShard(uint64_t key);
+    static void unlink(Shard& shard, uint32_t slot);
+    static void pushFront(Shard& shard, uint32_t slot);
+
+    size_t m_ShardCapacity;
+    Shard m_Shards[SHARD_COUNT];
+};
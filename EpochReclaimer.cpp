@@ -0,0 +1,42 @@
+#include "EpochReclaimer.h"
+#include <algorithm>
+#include <limits>
+
+EpochReclaimer::ReaderSlot& EpochReclaimer::registerReader() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Readers.emplace_back();
+    ReaderSlot& reader = m_Readers.back();
+    goOnline(reader);
+    return reader;
+}
+
+void EpochReclaimer::retire(std::shared_ptr<void> object) {
+    if (!object) return;
+    // The object is already unreachable for new readers; only those that were online
+    // before this epoch advanced can still see it.
+    uint64_t epoch = m_GlobalEpoch.fetch_add(1);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Retired.push_back({ epoch, std::move(object) });
+}
+
+void EpochReclaimer::collect() {
+    std::vector<RetiredObject> freed;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        uint64_t oldestActive = std::numeric_limits<uint64_t>::max();
+        for (const auto& reader : m_Readers) {
+            uint64_t epoch = reader.epoch.load();
+            if (epoch != 0) oldestActive = std::min(oldestActive, epoch);
+        }
+
+        auto firstKept = std::partition(m_Retired.begin(), m_Retired.end(),
+            [oldestActive](const RetiredObject& retired) { return retired.epoch < oldestActive; });
+        freed.assign(std::make_move_iterator(m_Retired.begin()), std::make_move_iterator(firstKept));
+        m_Retired.erase(m_Retired.begin(), firstKept);
+    }
+}
+
+size_t EpochReclaimer::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Retired.size();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Quiescent-state-based reclamation for data that lock-free readers may still be using.
+// Reader threads register once and report a quiescent state between units of work, when
+// they hold no pointers into shared data; a reader about to block goes offline instead.
+// Writers retire objects rather than deleting them, and collect() frees whatever was
+// retired before every online reader's last quiescent state.
+class EpochReclaimer {
+public:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{ 0 }; // 0 while offline
+    };
+
+    ReaderSlot& registerReader();
+    void quiescent(ReaderSlot& reader) {
+        reader.epoch.store(m_GlobalEpoch.load());
+        // Keep the reader's next loads of shared pointers after its announcement.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    void goOnline(ReaderSlot& reader) { quiescent(reader); }
+    void goOffline(ReaderSlot& reader) { reader.epoch.store(0); }
+
+    void retire(std::shared_ptr<void> object);
+    // Frees retired objects on the calling thread, so call it from the thread that owns
+    // any GL resources those objects release.
+    void collect();
+
+    size_t getPendingCount() const;
+
+private:
+    struct RetiredObject {
+        uint64_t epoch;
+        std::shared_ptr<void> object;
+    };
+
+    std::atomic<uint64_t> m_GlobalEpoch{ 1 };
+    std::deque<ReaderSlot> m_Readers;
+    std::vector<RetiredObject> m_Retired;
+    mutable std::mutex m_Mutex;
+};
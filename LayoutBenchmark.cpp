@@ -0,0 +1,133 @@
+#include "LayoutBenchmark.h"
+#include "Chunk.h"
+#include "Lighting.h"
+#include "Mesh.h"
+#include "Mesher.h"
+#include "TerrainGenerator.h"
+#include "WorldAccessor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+    const int BENCHMARK_SEED = 1337;
+    const int BENCHMARK_RADIUS = 4;
+    const int BENCHMARK_RUNS = 3;
+
+    // Fixed square of chunks around the origin, looked up like ChunkTable.
+    template<typename Layout>
+    class LayoutGrid {
+    public:
+        LayoutGrid() {
+            for (int x = -BENCHMARK_RADIUS; x <= BENCHMARK_RADIUS; ++x) {
+                for (int z = -BENCHMARK_RADIUS; z <= BENCHMARK_RADIUS; ++z) {
+                    m_Chunks.push_back(std::make_unique<BasicChunk<Layout>>(x, 0, z));
+                }
+            }
+        }
+
+        BasicChunk<Layout>* get(int chunkX, int chunkZ) const {
+            if (abs(chunkX) > BENCHMARK_RADIUS || abs(chunkZ) > BENCHMARK_RADIUS) return nullptr;
+            return m_Chunks[(chunkX + BENCHMARK_RADIUS) * DIAMETER + chunkZ + BENCHMARK_RADIUS].get();
+        }
+
+        const std::vector<std::unique_ptr<BasicChunk<Layout>>>& getChunks() const { return m_Chunks; }
+
+    private:
+        static const int DIAMETER = 2 * BENCHMARK_RADIUS + 1;
+        std::vector<std::unique_ptr<BasicChunk<Layout>>> m_Chunks;
+    };
+
+    struct LayoutTimings {
+        double generateMs = 1e30;
+        double lightMs = 1e30;
+        double meshMs = 1e30;
+        unsigned long long checksum = 0;
+    };
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template<typename Layout>
+    LayoutTimings benchmarkLayout() {
+        LayoutTimings best;
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+            LayoutGrid<Layout> grid;
+            const auto& chunks = grid.getChunks();
+
+            TerrainGenerator generator(BENCHMARK_SEED);
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& chunk : chunks) {
+                generator.generateChunkData(*chunk);
+            }
+            double generateMs = elapsedMs(start);
+
+            BasicWorldAccessor<LayoutGrid<Layout>> access(grid);
+            start = std::chrono::steady_clock::now();
+            for (const auto& chunk : chunks) {
+                computeInitialLight(*chunk, access);
+            }
+            double lightMs = elapsedMs(start);
+
+            // Only inner chunks have all eight neighbours, as in the game.
+            SimpleMesher mesher;
+            Mesh opaqueMesh;
+            Mesh transparentMesh;
+            unsigned long long checksum = 0;
+            int meshed = 0;
+            start = std::chrono::steady_clock::now();
+            for (int x = 1 - BENCHMARK_RADIUS; x < BENCHMARK_RADIUS; ++x) {
+                for (int z = 1 - BENCHMARK_RADIUS; z < BENCHMARK_RADIUS; ++z) {
+                    std::array<const BasicChunk<Layout>*, 9> neighbors{};
+                    int i = 0;
+                    for (int dz = -1; dz <= 1; ++dz) {
+                        for (int dx = -1; dx <= 1; ++dx) {
+                            neighbors[i++] = grid.get(x + dx, z + dz);
+                        }
+                    }
+                    ChunkMeshingData data(neighbors, LeafQuality::Fancy);
+                    mesher.generateMesh(data, glm::ivec3(x, 0, z), opaqueMesh, transparentMesh, true);
+                    checksum += opaqueMesh.indices.size() + transparentMesh.indices.size();
+                    meshed++;
+                }
+            }
+            double meshMs = elapsedMs(start);
+
+            for (const auto& chunk : chunks) {
+                for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                    for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+                        for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                            checksum = checksum * 31 + chunk->getBlock(x, y, z) * 256 + chunk->getSunlight(x, y, z) * 16 + chunk->getBlockLight(x, y, z);
+                        }
+                    }
+                }
+            }
+
+            best.generateMs = std::min(best.generateMs, generateMs / chunks.size());
+            best.lightMs = std::min(best.lightMs, lightMs / chunks.size());
+            best.meshMs = std::min(best.meshMs, meshMs / meshed);
+            best.checksum = checksum;
+        }
+        return best;
+    }
+
+    template<typename Layout>
+    void reportLayout(const char* name) {
+        LayoutTimings timings = benchmarkLayout<Layout>();
+        printf("%-8s %10.3f %10.3f %10.3f   %016llx\n", name, timings.generateMs, timings.lightMs, timings.meshMs, timings.checksum);
+    }
+}
+
+int runLayoutBenchmark() {
+    const int diameter = 2 * BENCHMARK_RADIUS + 1;
+    printf("Seed %d, %dx%d chunks, best of %d runs, ms per chunk\n", BENCHMARK_SEED, diameter, diameter, BENCHMARK_RUNS);
+    printf("%-8s %10s %10s %10s   %s\n", "layout", "generate", "light", "mesh", "checksum");
+    reportLayout<XYZLayout>("xyz");
+    reportLayout<YXZLayout>("yxz");
+    reportLayout<XZYLayout>("xzy");
+    reportLayout<MortonLayout>("morton");
+    return 0;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Runs terrain generation, initial lighting and meshing over the same seed-1337 area once
+// per voxel layout and prints per-chunk timings. Returns a process exit code.
+int runLayoutBenchmark();
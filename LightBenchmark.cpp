@@ -0,0 +1,366 @@
+#include "LightBenchmark.h"
+#include "Chunk.h"
+#include "Lighting.h"
+#include "Mesh.h"
+#include "TerrainGenerator.h"
+#include "WorldAccessor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace {
+    const int BENCHMARK_SEED = 1337;
+    const int BENCHMARK_RADIUS = 5;
+    const int BENCHMARK_RUNS = 3;
+    // Cube filled with stone and cleared again by the edit benchmark, across four chunks
+    // and clear of the top and bottom of the world.
+    const int EDIT_SIZE = 24;
+    const int EDIT_MIN_Y = 56;
+    // Chunks whose light the edit cube can change: the four it spans and the ring around
+    // them, since light fades out within 14 blocks of the cube.
+    const int EDIT_REGION_MIN = -2;
+    const int EDIT_REGION_MAX = 1;
+
+    unsigned long long addToChecksum(unsigned long long checksum, const unsigned char* light) {
+        for (int i = 0; i < CHUNK_VOLUME; ++i) {
+            checksum = checksum * 31 + light[i];
+        }
+        return checksum;
+    }
+
+    // Fixed square of chunks around the origin, looked up like ChunkTable.
+    class LightGrid {
+    public:
+        LightGrid(const TerrainGenerator& generator, bool caves) {
+            for (int x = -BENCHMARK_RADIUS; x <= BENCHMARK_RADIUS; ++x) {
+                for (int z = -BENCHMARK_RADIUS; z <= BENCHMARK_RADIUS; ++z) {
+                    m_Chunks.push_back(std::make_unique<Chunk>(x, 0, z));
+                    generator.generateChunkData(*m_Chunks.back());
+                    if (caves) carveCaves(*m_Chunks.back(), (x & 1) != 0);
+                }
+            }
+        }
+
+        Chunk* get(int chunkX, int chunkZ) const {
+            if (abs(chunkX) > BENCHMARK_RADIUS || abs(chunkZ) > BENCHMARK_RADIUS) return nullptr;
+            return m_Chunks[(chunkX + BENCHMARK_RADIUS) * DIAMETER + chunkZ + BENCHMARK_RADIUS].get();
+        }
+
+        const std::vector<std::unique_ptr<Chunk>>& getChunks() const { return m_Chunks; }
+
+        unsigned long long getLightChecksum() const {
+            std::vector<unsigned char> light(CHUNK_VOLUME);
+            unsigned long long checksum = 0;
+            for (const auto& chunk : m_Chunks) {
+                chunk->getLightLevels(light.data());
+                checksum = addToChecksum(checksum, light.data());
+            }
+            return checksum;
+        }
+
+        // Over the chunks of the edit region only.
+        unsigned long long getEditRegionChecksum() const {
+            std::vector<unsigned char> light(CHUNK_VOLUME);
+            unsigned long long checksum = 0;
+            for (int x = EDIT_REGION_MIN; x <= EDIT_REGION_MAX; ++x) {
+                for (int z = EDIT_REGION_MIN; z <= EDIT_REGION_MAX; ++z) {
+                    get(x, z)->getLightLevels(light.data());
+                    checksum = addToChecksum(checksum, light.data());
+                }
+            }
+            return checksum;
+        }
+
+    private:
+        static const int DIAMETER = 2 * BENCHMARK_RADIUS + 1;
+
+        // The generator only makes heightmap terrain, which sunlight fills straight down.
+        // This hollows a room a few blocks under the surface, lit through a shaft in its
+        // middle, so light has to spread sideways. In every other row of chunks the rooms
+        // run into each other, so their light is spread across chunk borders.
+        static void carveCaves(Chunk& chunk, bool open) {
+            const int margin = open ? 0 : 2;
+            for (int x = margin; x < CHUNK_WIDTH - margin; ++x) {
+                for (int z = margin; z < CHUNK_DEPTH - margin; ++z) {
+                    const int height = chunk.getHeight(x, z);
+                    const bool shaft = x >= 7 && x < 9 && z >= 7 && z < 9;
+                    const bool pillar = x % 5 == 0 && z % 5 == 0;
+                    const int top = shaft ? height : height - 4;
+                    for (int y = std::max(1, height - 8); y < top && !pillar; ++y) {
+                        chunk.setBlock(x, y, z, static_cast<unsigned char>(BlockID::Air));
+                    }
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<Chunk>> m_Chunks;
+    };
+
+    // LightQueue nodes pushed per ms and per edit over every timed pass, and queue
+    // allocations in the last run, once the thread's queues have warmed up.
+    struct QueueUsage {
+        double nodesPerMs = 0.0;
+        double nodesPerEdit = 0.0;
+        unsigned long long warmAllocations = 0;
+    };
+
+    // Sums LightQueue activity over timed passes.
+    class QueueCounter {
+    public:
+        void startRun() { m_RunStart = LightQueue::getStats(); }
+        void startPass() { m_PassStart = LightQueue::getStats(); }
+        void endPass(double ms, int edits) {
+            m_Nodes += LightQueue::getStats().nodes - m_PassStart.nodes;
+            m_Ms += ms;
+            m_Edits += edits;
+        }
+
+        QueueUsage getUsage() const {
+            QueueUsage usage;
+            usage.nodesPerMs = m_Ms > 0.0 ? m_Nodes / m_Ms : 0.0;
+            usage.nodesPerEdit = m_Edits > 0 ? static_cast<double>(m_Nodes) / m_Edits : 0.0;
+            usage.warmAllocations = LightQueue::getStats().allocations - m_RunStart.allocations;
+            return usage;
+        }
+
+    private:
+        LightQueue::Stats m_RunStart;
+        LightQueue::Stats m_PassStart;
+        unsigned long long m_Nodes = 0;
+        double m_Ms = 0.0;
+        unsigned long long m_Edits = 0;
+    };
+
+    struct LightTimings {
+        double initialMs = 1e30;
+        double relightMs = 1e30;
+        unsigned long long initialChecksum = 0;
+        unsigned long long relightChecksum = 0;
+    };
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template<typename Kernel>
+    LightTimings benchmarkKernel(const TerrainGenerator& generator, bool caves, Kernel kernel) {
+        LightTimings best;
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+            LightGrid grid(generator, caves);
+            const auto& chunks = grid.getChunks();
+            BasicWorldAccessor<LightGrid> access(grid);
+
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& chunk : chunks) {
+                kernel(*chunk, access);
+            }
+            best.initialMs = std::min(best.initialMs, elapsedMs(start) / chunks.size());
+            best.initialChecksum = grid.getLightChecksum();
+
+            // Every neighbour is lit by now, so this is the full-column relight an edit-heavy
+            // area sees.
+            start = std::chrono::steady_clock::now();
+            for (const auto& chunk : chunks) {
+                kernel(*chunk, access);
+            }
+            best.relightMs = std::min(best.relightMs, elapsedMs(start) / chunks.size());
+            best.relightChecksum = grid.getLightChecksum();
+        }
+        return best;
+    }
+
+    struct ChunkPosLess {
+        bool operator()(const glm::ivec3& a, const glm::ivec3& b) const {
+            return a.x != b.x ? a.x < b.x : a.z < b.z;
+        }
+    };
+
+    struct EditTimings {
+        double fillMs = 1e30;
+        double clearMs = 1e30;
+        unsigned long long fillChecksum = 0;
+        unsigned long long clearChecksum = 0;
+        unsigned long long fillRegionChecksum = 0;
+        unsigned long long clearRegionChecksum = 0;
+        QueueUsage queues;
+    };
+
+    // Applies one block edit the way World::setBlock does and returns its update.
+    LightUpdateJob applyEdit(LightGrid& grid, const glm::ivec3& pos, BlockID block) {
+        Chunk* chunk = grid.get(pos.x >> CHUNK_WIDTH_SHIFT, pos.z >> CHUNK_DEPTH_SHIFT);
+        int x = pos.x & CHUNK_WIDTH_MASK;
+        int z = pos.z & CHUNK_DEPTH_MASK;
+        LightUpdateJob update{ pos, static_cast<BlockID>(chunk->getBlock(x, pos.y, z)), block, chunk->getHeight(x, z), 0 };
+        chunk->setBlock(x, pos.y, z, static_cast<unsigned char>(block));
+        update.newHeight = chunk->getHeight(x, z);
+        return update;
+    }
+
+    // Light of the edit region with the cube set to block, relit from scratch by
+    // computeInitialLightReference as a check on updateLight that shares none of its code.
+    // The reference kernel clears a chunk's light before flooding it, which would wipe what
+    // chunks lit before it spilled in. So every chunk is flooded on its own with its
+    // neighbours dark, and each voxel keeps the brightest sunlight and block light any of
+    // them gave it.
+    unsigned long long getReferenceEditChecksum(const TerrainGenerator& generator, BlockID block) {
+        LightGrid grid(generator, false);
+        BasicWorldAccessor<LightGrid> access(grid);
+        for (int x = -EDIT_SIZE / 2; x < EDIT_SIZE / 2; ++x) {
+            for (int z = -EDIT_SIZE / 2; z < EDIT_SIZE / 2; ++z) {
+                for (int y = EDIT_MIN_Y; y < EDIT_MIN_Y + EDIT_SIZE; ++y) {
+                    applyEdit(grid, { x, y, z }, block);
+                }
+            }
+        }
+
+        const int regionSize = EDIT_REGION_MAX - EDIT_REGION_MIN + 1;
+        std::vector<unsigned char> brightest(regionSize * regionSize * CHUNK_VOLUME, 0);
+        std::vector<unsigned char> light(CHUNK_VOLUME);
+        for (int sourceX = EDIT_REGION_MIN - 1; sourceX <= EDIT_REGION_MAX + 1; ++sourceX) {
+            for (int sourceZ = EDIT_REGION_MIN - 1; sourceZ <= EDIT_REGION_MAX + 1; ++sourceZ) {
+                for (int x = sourceX - 1; x <= sourceX + 1; ++x) {
+                    for (int z = sourceZ - 1; z <= sourceZ + 1; ++z) {
+                        for (int sectionY = 0; sectionY < SECTION_COUNT; ++sectionY) {
+                            grid.get(x, z)->fillSectionLight(sectionY, 0, 0);
+                        }
+                    }
+                }
+                computeInitialLightReference(*grid.get(sourceX, sourceZ), access);
+
+                for (int x = sourceX - 1; x <= sourceX + 1; ++x) {
+                    for (int z = sourceZ - 1; z <= sourceZ + 1; ++z) {
+                        if (x < EDIT_REGION_MIN || x > EDIT_REGION_MAX || z < EDIT_REGION_MIN || z > EDIT_REGION_MAX) continue;
+                        grid.get(x, z)->getLightLevels(light.data());
+                        unsigned char* out = &brightest[((x - EDIT_REGION_MIN) * regionSize + z - EDIT_REGION_MIN) * CHUNK_VOLUME];
+                        for (int i = 0; i < CHUNK_VOLUME; ++i) {
+                            out[i] = std::max(out[i] & 0xF0, light[i] & 0xF0) | std::max(out[i] & 0x0F, light[i] & 0x0F);
+                        }
+                    }
+                }
+            }
+        }
+
+        unsigned long long checksum = 0;
+        for (int chunk = 0; chunk < regionSize * regionSize; ++chunk) {
+            checksum = addToChecksum(checksum, &brightest[chunk * CHUNK_VOLUME]);
+        }
+        return checksum;
+    }
+
+    // Fills the edit cube with stone and clears it to air, once lighting every edit on its
+    // own as it is made, as edits used to be, and once lighting each pass as one batch.
+    EditTimings benchmarkEdits(const TerrainGenerator& generator, bool batched) {
+        EditTimings best;
+        QueueCounter counter;
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+            LightGrid grid(generator, false);
+            BasicWorldAccessor<LightGrid> access(grid);
+            for (const auto& chunk : grid.getChunks()) {
+                computeInitialLight(*chunk, access);
+            }
+            counter.startRun();
+
+            for (BlockID block : { BlockID::Stone, BlockID::Air }) {
+                std::set<glm::ivec3, ChunkPosLess> changedChunks;
+                std::vector<LightUpdateJob> updates;
+                counter.startPass();
+                auto start = std::chrono::steady_clock::now();
+                for (int x = -EDIT_SIZE / 2; x < EDIT_SIZE / 2; ++x) {
+                    for (int z = -EDIT_SIZE / 2; z < EDIT_SIZE / 2; ++z) {
+                        for (int y = EDIT_MIN_Y; y < EDIT_MIN_Y + EDIT_SIZE; ++y) {
+                            updates.push_back(applyEdit(grid, { x, y, z }, block));
+                            if (!batched) {
+                                updateLight(updates, access, changedChunks);
+                                updates.clear();
+                            }
+                        }
+                    }
+                }
+                updateLight(updates, access, changedChunks);
+                double ms = elapsedMs(start);
+                counter.endPass(ms, static_cast<int>(EDIT_SIZE * EDIT_SIZE * EDIT_SIZE));
+
+                if (block == BlockID::Stone) {
+                    best.fillMs = std::min(best.fillMs, ms);
+                    best.fillChecksum = grid.getLightChecksum();
+                    best.fillRegionChecksum = grid.getEditRegionChecksum();
+                }
+                else {
+                    best.clearMs = std::min(best.clearMs, ms);
+                    best.clearChecksum = grid.getLightChecksum();
+                    best.clearRegionChecksum = grid.getEditRegionChecksum();
+                }
+            }
+        }
+        best.queues = counter.getUsage();
+        return best;
+    }
+}
+
+int runLightBenchmark() {
+    const int diameter = 2 * BENCHMARK_RADIUS + 1;
+    printf("Seed %d, %dx%d chunks, best of %d runs, ms per chunk\n", BENCHMARK_SEED, diameter, diameter, BENCHMARK_RUNS);
+
+    TerrainGenerator generator(BENCHMARK_SEED);
+    bool matches = true;
+    for (bool caves : { false, true }) {
+        LightTimings reference = benchmarkKernel(generator, caves, [](Chunk& chunk, BasicWorldAccessor<LightGrid>& access) {
+            computeInitialLightReference(chunk, access);
+            });
+        LightTimings padded = benchmarkKernel(generator, caves, [](Chunk& chunk, BasicWorldAccessor<LightGrid>& access) {
+            computeInitialLight(chunk, access);
+            });
+
+        printf("\n%s\n", caves ? "With carved caves" : "Terrain as generated");
+        printf("%-10s %10s %10s   %-16s %s\n", "kernel", "initial", "relight", "initial checksum", "relight checksum");
+        printf("%-10s %10.3f %10.3f   %016llx %016llx\n", "reference", reference.initialMs, reference.relightMs,
+            reference.initialChecksum, reference.relightChecksum);
+        printf("%-10s %10.3f %10.3f   %016llx %016llx\n", "padded", padded.initialMs, padded.relightMs,
+            padded.initialChecksum, padded.relightChecksum);
+        printf("Speed-up: %.1fx initial, %.1fx relight\n", reference.initialMs / padded.initialMs, reference.relightMs / padded.relightMs);
+
+        bool same = reference.initialChecksum == padded.initialChecksum && reference.relightChecksum == padded.relightChecksum;
+        printf("Light %s\n", same ? "matches" : "DIFFERS");
+        matches = matches && same;
+    }
+
+    const int edits = EDIT_SIZE * EDIT_SIZE * EDIT_SIZE;
+    printf("\n%d edits filling a %d^3 cube with stone and clearing it, best of %d runs, thousand edits/s\n",
+        edits, EDIT_SIZE, BENCHMARK_RUNS);
+    EditTimings perEdit = benchmarkEdits(generator, false);
+    EditTimings batched = benchmarkEdits(generator, true);
+
+    printf("%-10s %10s %10s   %-16s %s\n", "updates", "fill", "clear", "fill checksum", "clear checksum");
+    printf("%-10s %10.1f %10.1f   %016llx %016llx\n", "per edit", edits / perEdit.fillMs, edits / perEdit.clearMs,
+        perEdit.fillChecksum, perEdit.clearChecksum);
+    printf("%-10s %10.1f %10.1f   %016llx %016llx\n", "batched", edits / batched.fillMs, edits / batched.clearMs,
+        batched.fillChecksum, batched.clearChecksum);
+    printf("Speed-up: %.1fx fill, %.1fx clear\n", perEdit.fillMs / batched.fillMs, perEdit.clearMs / batched.clearMs);
+
+    bool editsMatch = perEdit.fillChecksum == batched.fillChecksum && perEdit.clearChecksum == batched.clearChecksum;
+    printf("Edited light %s\n", editsMatch ? "matches" : "DIFFERS");
+
+    const int regionSize = EDIT_REGION_MAX - EDIT_REGION_MIN + 1;
+    printf("\nLight of the %dx%d chunks around the cube, against a from-scratch reference relight\n", regionSize, regionSize);
+    const unsigned long long referenceFill = getReferenceEditChecksum(generator, BlockID::Stone);
+    const unsigned long long referenceClear = getReferenceEditChecksum(generator, BlockID::Air);
+    printf("%-10s %-16s %s\n", "updates", "fill checksum", "clear checksum");
+    printf("%-10s %016llx %016llx\n", "per edit", perEdit.fillRegionChecksum, perEdit.clearRegionChecksum);
+    printf("%-10s %016llx %016llx\n", "batched", batched.fillRegionChecksum, batched.clearRegionChecksum);
+    printf("%-10s %016llx %016llx\n", "reference", referenceFill, referenceClear);
+    bool referenceMatches = true;
+    for (const EditTimings* timings : { &perEdit, &batched }) {
+        referenceMatches = referenceMatches && timings->fillRegionChecksum == referenceFill && timings->clearRegionChecksum == referenceClear;
+    }
+    printf("Edited light %s the reference\n", referenceMatches ? "matches" : "DIFFERS from");
+
+    printf("\nEdit light queues, million nodes/s and nodes per edit over every run, allocations in the last run\n");
+    printf("%-10s %10s %10s %10s\n", "updates", "nodes/s", "per edit", "allocs");
+    printf("%-10s %10.2f %10.1f %10llu\n", "per edit", perEdit.queues.nodesPerMs / 1000.0, perEdit.queues.nodesPerEdit, perEdit.queues.warmAllocations);
+    printf("%-10s %10.2f %10.1f %10llu\n", "batched", batched.queues.nodesPerMs / 1000.0, batched.queues.nodesPerEdit, batched.queues.warmAllocations);
+    return matches && editsMatch && referenceMatches ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Lights the same seed-1337 area with the per-voxel reference kernel and with
+// computeInitialLight, first fresh and then as a full relight of every already-lit chunk,
+// and prints ms per chunk, the speed-up and whether both produced the same light; once as
+// generated and once with caves carved under the surface, so sunlight has to spread. Then
+// fills a cube with stone and clears it, updating light per edit and in one batch per
+// pass, and prints the edit throughput of each the same way. Both are checked against the
+// chunks around the cube relit from scratch by the reference kernel, and followed by how
+// many LightQueue nodes per second and per edit their floods went through and whether
+// their queues still allocated once warmed up.
+// Needs no window or GL. Returns a process exit code, 1 if the results differ.
+int runLightBenchmark();
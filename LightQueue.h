@@ -0,0 +1,205 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+
+// FIFO of packed 32-bit light flood nodes. The nodes sit in a power-of-two ring that
+// doubles when full and is never shrunk, so a queue kept per thread stops allocating
+// once it has held its largest flood.
+class LightQueue {
+public:
+    struct Stats {
+        // Times any queue's storage grew, over the life of the process.
+        uint64_t allocations = 0;
+        // Nodes pushed by floods that have been cleared since.
+        uint64_t nodes = 0;
+    };
+
+    LightQueue() = default;
+    LightQueue(const LightQueue&) = delete;
+    LightQueue& operator=(const LightQueue&) = delete;
+    ~LightQueue() { clear(); }
+
+    bool empty() const { return m_Head == m_Tail; }
+
+    void push(uint32_t node) {
+        if (m_Tail - m_Head == m_Capacity) grow();
+        m_Nodes[m_Tail++ & (m_Capacity - 1)] = node;
+    }
+
+    uint32_t pop() { return m_Nodes[m_Head++ & (m_Capacity - 1)]; }
+
+    // Drops any queued nodes and adds what was pushed since the last clear to the stats.
+    void clear() {
+        if (m_Tail > 0) s_Nodes.fetch_add(m_Tail, std::memory_order_relaxed);
+        m_Head = 0;
+        m_Tail = 0;
+    }
+
+    static Stats getStats() {
+        Stats stats;
+        stats.allocations = s_Allocations.load(std::memory_order_relaxed);
+        stats.nodes = s_Nodes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    static const size_t INITIAL_CAPACITY = 4096;
+
+    void grow() {
+        size_t capacity = m_Capacity > 0 ? m_Capacity * 2 : INITIAL_CAPACITY;
+        std::unique_ptr<uint32_t[]> nodes(new uint32_t[capacity]);
+        for (size_t i = m_Head; i != m_Tail; ++i) {
+            nodes[i - m_Head] = m_Nodes[i & (m_Capacity - 1)];
+        }
+        m_Tail -= m_Head;
+        m_Head = 0;
+        m_Nodes = std::move(nodes);
+        m_Capacity = capacity;
+        s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<uint32_t[]> m_Nodes;
+    size_t m_Capacity = 0;
+    // Count every node pushed and popped since the last clear; only their difference is
+    // wrapped into the ring.
+    size_t m_Head = 0;
+    size_t m_Tail = 0;
+
+    static inline std::atomic<uint64_t> s_Allocations{ 0 };
+    static inline std::atomic<uint64_t> s_Nodes{ 0 };
+};
+
+// Packs world positions and light levels into LightQueue nodes: the level in the low 4
+// bits, then the position within its chunk, then the chunk's index in a sidecar table of
+// the chunks the flood has reached so far. The table is kept between floods, cleared by
+// reset().
+class LightNodePacker {
+public:
+    // Chunks one flood may reach between resets, as many as the index bits allow. Light
+    // from one edit reaches at most the 3x3 chunks around it, which is what LightScheduler
+    // bounds its batches by.
+    static const int MAX_CHUNKS = 1 << 13;
+
+    LightNodePacker() : m_Slots(TABLE_SIZE, EMPTY_SLOT) {
+        m_Chunks.reserve(MAX_CHUNKS);
+        m_Used.reserve(MAX_CHUNKS);
+    }
+
+    uint32_t pack(const glm::ivec3& pos, unsigned char level) {
+        const int chunkX = pos.x >> CHUNK_WIDTH_SHIFT;
+        const int chunkZ = pos.z >> CHUNK_DEPTH_SHIFT;
+        if (m_LastChunk < 0 || m_Chunks[m_LastChunk].x != chunkX || m_Chunks[m_LastChunk].y != chunkZ) {
+            m_LastChunk = findChunk(chunkX, chunkZ);
+        }
+        const uint32_t local = (static_cast<uint32_t>(pos.x & CHUNK_WIDTH_MASK) * CHUNK_DEPTH + (pos.z & CHUNK_DEPTH_MASK)) * CHUNK_HEIGHT + pos.y;
+        return static_cast<uint32_t>(m_LastChunk) << INDEX_SHIFT | local << 4 | level;
+    }
+
+    glm::ivec3 getPosition(uint32_t node) const {
+        const glm::ivec2& chunk = m_Chunks[node >> INDEX_SHIFT];
+        const uint32_t local = (node >> 4) & (CHUNK_VOLUME - 1);
+        const int y = local % CHUNK_HEIGHT;
+        const int z = (local / CHUNK_HEIGHT) % CHUNK_DEPTH;
+        const int x = local / (CHUNK_HEIGHT * CHUNK_DEPTH);
+        return { chunk.x * CHUNK_WIDTH + x, y, chunk.y * CHUNK_DEPTH + z };
+    }
+
+    static unsigned char getLevel(uint32_t node) { return node & 0x0F; }
+
+    void reset() {
+        for (uint32_t slot : m_Used) m_Slots[slot] = EMPTY_SLOT;
+        m_Used.clear();
+        m_Chunks.clear();
+        m_LastChunk = -1;
+    }
+
+private:
+    static_assert(1ull * CHUNK_VOLUME * 16 * MAX_CHUNKS == (1ull << 32), "light nodes must fill 32 bits");
+    static const int INDEX_SHIFT = 32 - 13;
+    // Open-addressed from chunk coordinates to chunk index, at most half full.
+    static const uint32_t TABLE_SIZE = 2 * MAX_CHUNKS;
+    static const uint16_t EMPTY_SLOT = 0xFFFF;
+
+    int findChunk(int chunkX, int chunkZ) {
+        uint32_t slot = (static_cast<uint32_t>(chunkX) * 73856093u ^ static_cast<uint32_t>(chunkZ) * 19349663u) & (TABLE_SIZE - 1);
+        while (m_Slots[slot] != EMPTY_SLOT) {
+            const glm::ivec2& chunk = m_Chunks[m_Slots[slot]];
+            if (chunk.x == chunkX && chunk.y == chunkZ) return m_Slots[slot];
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+        m_Slots[slot] = static_cast<uint16_t>(m_Chunks.size());
+        m_Used.push_back(slot);
+        m_Chunks.emplace_back(chunkX, chunkZ);
+        return m_Slots[slot];
+    }
+
+    std::vector<glm::ivec2> m_Chunks;
+    std::vector<uint16_t> m_Slots;
+    std::vector<uint32_t> m_Used;
+    int m_LastChunk = -1;
+};
+
+// Numbers distinct 64-bit keys in the order they are first added, for the per-batch
+// bookkeeping of a light update. Open-addressed like LightNodePacker and cleared the same
+// way, so one kept per thread stops allocating once it has held its largest batch.
+class LightKeyIndex {
+public:
+    static constexpr uint32_t NOT_FOUND = 0xFFFFFFFF;
+
+    // Returns the key's index, adding it as the next one if it is new.
+    uint32_t insert(uint64_t key) {
+        if (2 * (m_Keys.size() + 1) > m_Slots.size()) grow();
+        uint32_t slot = findSlot(key);
+        if (m_Slots[slot] == NOT_FOUND) {
+            m_Slots[slot] = static_cast<uint32_t>(m_Keys.size());
+            m_Used.push_back(slot);
+            m_Keys.push_back(key);
+        }
+        return m_Slots[slot];
+    }
+
+    uint32_t find(uint64_t key) const {
+        return m_Slots.empty() ? NOT_FOUND : m_Slots[findSlot(key)];
+    }
+
+    bool contains(uint64_t key) const { return find(key) != NOT_FOUND; }
+
+    size_t size() const { return m_Keys.size(); }
+
+    void clear() {
+        for (uint32_t slot : m_Used) m_Slots[slot] = NOT_FOUND;
+        m_Used.clear();
+        m_Keys.clear();
+    }
+
+private:
+    static const size_t INITIAL_SLOTS = 1024;
+
+    uint32_t findSlot(uint64_t key) const {
+        const size_t mask = m_Slots.size() - 1;
+        size_t slot = (key * 0x9E3779B97F4A7C15ull) >> 32 & mask;
+        while (m_Slots[slot] != NOT_FOUND && m_Keys[m_Slots[slot]] != key) {
+            slot = (slot + 1) & mask;
+        }
+        return static_cast<uint32_t>(slot);
+    }
+
+    void grow() {
+        m_Slots.assign(m_Slots.empty() ? INITIAL_SLOTS : m_Slots.size() * 2, NOT_FOUND);
+        m_Used.clear();
+        for (uint32_t i = 0; i < m_Keys.size(); ++i) {
+            uint32_t slot = findSlot(m_Keys[i]);
+            m_Slots[slot] = i;
+            m_Used.push_back(slot);
+        }
+    }
+
+    std::vector<uint64_t> m_Keys;
+    std::vector<uint32_t> m_Slots;
+    // Slots in use, so clearing a large table after a small batch stays cheap.
+    std::vector<uint32_t> m_Used;
+};
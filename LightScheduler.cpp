@@ -0,0 +1,171 @@
+#include "LightScheduler.h"
+#include "Chunk.h"
+#include <algorithm>
+
+void LightScheduler::pushInitial(const glm::ivec3& chunkPos) {
+    LightJob job;
+    job.type = LightJob::Type::Initial;
+    job.chunks.push_back(chunkPos);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Queue.push_back(job);
+    m_Condition.notify_one();
+}
+
+void LightScheduler::pushUpdate(const LightUpdateJob& update) {
+    LightJob job;
+    job.type = LightJob::Type::Update;
+    job.chunks.emplace_back(update.pos.x >> CHUNK_WIDTH_SHIFT, 0, update.pos.z >> CHUNK_DEPTH_SHIFT);
+    job.updates.push_back(update);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Queue.push_back(job);
+    m_Condition.notify_one();
+}
+
+bool LightScheduler::acquire(LightJob& job) {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    auto waitStart = std::chrono::steady_clock::now();
+    while (true) {
+        if (!m_IsActive) return false;
+        // Jobs skipped on the way keep their neighbourhood reserved, so nothing later that
+        // overlaps them runs first. Each pass starts over from the front of the queue.
+        std::unordered_set<uint64_t> skipped;
+        if (takeRunnable(LightJob::Type::Update, skipped, job)) {
+            takeBatch(skipped, job);
+            break;
+        }
+        skipped.clear();
+        if (takeRunnable(LightJob::Type::Initial, skipped, job)) break;
+        m_Condition.wait(lock);
+    }
+    insertNeighborhood(job, m_Claimed);
+    m_Running++;
+    job.startedAt = std::chrono::steady_clock::now();
+    m_IdleNs += std::chrono::duration_cast<std::chrono::nanoseconds>(job.startedAt - waitStart).count();
+    return true;
+}
+
+void LightScheduler::release(const LightJob& job) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const glm::ivec3& chunkPos : job.chunks) {
+        for (int z = -1; z <= 1; ++z) {
+            for (int x = -1; x <= 1; ++x) {
+                m_Claimed.erase(getKey(chunkPos.x + x, chunkPos.z + z));
+            }
+        }
+    }
+    m_Running--;
+    if (job.type == LightJob::Type::Initial) {
+        m_InitialJobs++;
+    }
+    else {
+        m_UpdateJobs += job.updates.size();
+        m_UpdateBatches++;
+    }
+    m_BusyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(now - job.startedAt).count();
+    // Any waiting worker may be able to take a job that overlapped this one.
+    m_Condition.notify_all();
+}
+
+void LightScheduler::stop() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_IsActive = false;
+    m_Condition.notify_all();
+}
+
+void LightScheduler::registerWorker() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Workers++;
+}
+
+LightScheduler::Stats LightScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - m_SampleTime).count();
+    size_t jobs = m_InitialJobs + m_UpdateJobs;
+    LightQueue::Stats queueStats = LightQueue::getStats();
+    if (seconds >= 1.0) {
+        // Time spent in a wait or job that is still going is only counted once it ends.
+        long long busy = m_BusyNs - m_SampleBusyNs;
+        long long total = busy + (m_IdleNs - m_SampleIdleNs);
+        m_BusyFraction = total > 0 ? static_cast<double>(busy) / total : 0.0;
+        m_JobsPerSecond = (jobs - m_SampleJobs) / seconds;
+        m_NodesPerSecond = (queueStats.nodes - m_SampleNodes) / seconds;
+        m_SampleTime = now;
+        m_SampleBusyNs = m_BusyNs;
+        m_SampleIdleNs = m_IdleNs;
+        m_SampleJobs = jobs;
+        m_SampleNodes = queueStats.nodes;
+    }
+
+    Stats stats;
+    stats.workers = m_Workers;
+    stats.queued = m_Queue.size();
+    stats.running = m_Running;
+    stats.initialJobs = m_InitialJobs;
+    stats.updateJobs = m_UpdateJobs;
+    stats.updateBatches = m_UpdateBatches;
+    stats.busyFraction = m_BusyFraction;
+    stats.jobsPerSecond = m_JobsPerSecond;
+    stats.nodesPerSecond = m_NodesPerSecond;
+    stats.queueAllocations = queueStats.allocations;
+    return stats;
+}
+
+bool LightScheduler::overlaps(const LightJob& job, const std::unordered_set<uint64_t>& keys) const {
+    for (const glm::ivec3& chunkPos : job.chunks) {
+        for (int z = -1; z <= 1; ++z) {
+            for (int x = -1; x <= 1; ++x) {
+                if (keys.count(getKey(chunkPos.x + x, chunkPos.z + z))) return true;
+            }
+        }
+    }
+    return false;
+}
+
+void LightScheduler::insertNeighborhood(const LightJob& job, std::unordered_set<uint64_t>& keys) const {
+    for (const glm::ivec3& chunkPos : job.chunks) {
+        for (int z = -1; z <= 1; ++z) {
+            for (int x = -1; x <= 1; ++x) {
+                keys.insert(getKey(chunkPos.x + x, chunkPos.z + z));
+            }
+        }
+    }
+}
+
+bool LightScheduler::takeRunnable(LightJob::Type type, std::unordered_set<uint64_t>& skipped, LightJob& job) {
+    for (auto it = m_Queue.begin(); it != m_Queue.end(); ++it) {
+        // Jobs of the other type are passed over, but still hold back later ones they overlap.
+        if (it->type != type || overlaps(*it, m_Claimed) || overlaps(*it, skipped)) {
+            insertNeighborhood(*it, skipped);
+            continue;
+        }
+        job = std::move(*it);
+        m_Queue.erase(it);
+        return true;
+    }
+    return false;
+}
+
+void LightScheduler::takeBatch(std::unordered_set<uint64_t>& skipped, LightJob& job) {
+    std::deque<LightJob> remaining;
+    for (LightJob& queued : m_Queue) {
+        if (queued.type != LightJob::Type::Update || overlaps(queued, m_Claimed) || overlaps(queued, skipped)) {
+            insertNeighborhood(queued, skipped);
+            remaining.push_back(std::move(queued));
+            continue;
+        }
+        const glm::ivec3& chunkPos = queued.chunks.front();
+        if (std::find(job.chunks.begin(), job.chunks.end(), chunkPos) == job.chunks.end()) {
+            // Light from the batch must stay within the chunks a flood can pack.
+            if (job.chunks.size() == MAX_BATCH_CHUNKS) {
+                insertNeighborhood(queued, skipped);
+                remaining.push_back(std::move(queued));
+                continue;
+            }
+            job.chunks.push_back(chunkPos);
+        }
+        job.updates.push_back(queued.updates.front());
+    }
+    m_Queue.swap(remaining);
+}
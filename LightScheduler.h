@@ -0,0 +1,101 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Lighting.h"
+#include "LightQueue.h"
+
+struct LightJob {
+    enum class Type : uint8_t { Initial, Update };
+
+    Type type = Type::Initial;
+    // The chunk to light, or the chunks of the edits in updates.
+    std::vector<glm::ivec3> chunks;
+    std::vector<LightUpdateJob> updates; // Update jobs only, in edit order
+    std::chrono::steady_clock::time_point startedAt;
+};
+
+// Hands lighting jobs to a pool of workers. Light from a job can spill one chunk in every
+// direction, so a job claims the 3x3 chunks around each of its chunks while it runs and no
+// other job touching any of them starts until it is released. Jobs never overtake an
+// earlier queued job they overlap, of either type, so edits to one area are applied in
+// order and never before the area's initial light; edits go ahead of initial lighting
+// elsewhere. Every queued edit that can run when a worker takes one is handed out with it
+// as a single batch. Workers block in acquire() while nothing can run.
+class LightScheduler {
+public:
+    struct Stats {
+        size_t workers = 0;
+        size_t queued = 0;
+        size_t running = 0;
+        size_t initialJobs = 0;
+        size_t updateJobs = 0;
+        // Batches the update jobs were handed out in.
+        size_t updateBatches = 0;
+        // Over the last sampling interval of about a second.
+        double busyFraction = 0.0;
+        double jobsPerSecond = 0.0;
+        // Light flood nodes queued per second, and how often LightQueue storage has grown.
+        double nodesPerSecond = 0.0;
+        uint64_t queueAllocations = 0;
+    };
+
+    void pushInitial(const glm::ivec3& chunkPos);
+    void pushUpdate(const LightUpdateJob& update);
+
+    // Blocks until a job whose neighbourhood is free can start, or the scheduler stops.
+    // Returns false once stopped.
+    bool acquire(LightJob& job);
+    // Frees the job's neighbourhood and counts it as done.
+    void release(const LightJob& job);
+    void stop();
+
+    void registerWorker();
+    Stats getStats() const;
+
+private:
+    static uint64_t getKey(int chunkX, int chunkZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkZ);
+    }
+    bool overlaps(const LightJob& job, const std::unordered_set<uint64_t>& keys) const;
+    void insertNeighborhood(const LightJob& job, std::unordered_set<uint64_t>& keys) const;
+    // Takes the first queued job of the given type that overlaps neither a running job nor
+    // an earlier queued one.
+    bool takeRunnable(LightJob::Type type, std::unordered_set<uint64_t>& skipped, LightJob& job);
+    // Moves every later queued update that can run alongside job into it, up to
+    // MAX_BATCH_CHUNKS edited chunks.
+    void takeBatch(std::unordered_set<uint64_t>& skipped, LightJob& job);
+
+    static const size_t MAX_BATCH_CHUNKS = LightNodePacker::MAX_CHUNKS / 9;
+
+    // Both kinds of job, in the order they were pushed.
+    std::deque<LightJob> m_Queue;
+    // Chunks in the neighbourhood of a running job.
+    std::unordered_set<uint64_t> m_Claimed;
+    size_t m_Running = 0;
+    bool m_IsActive = true;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+
+    size_t m_Workers = 0;
+    size_t m_InitialJobs = 0;
+    size_t m_UpdateJobs = 0;
+    size_t m_UpdateBatches = 0;
+    long long m_BusyNs = 0;
+    long long m_IdleNs = 0;
+
+    // Totals at the start of the current sampling interval and the rates from the last one.
+    mutable std::chrono::steady_clock::time_point m_SampleTime = std::chrono::steady_clock::now();
+    mutable long long m_SampleBusyNs = 0;
+    mutable long long m_SampleIdleNs = 0;
+    mutable size_t m_SampleJobs = 0;
+    mutable double m_BusyFraction = 0.0;
+    mutable double m_JobsPerSecond = 0.0;
+    mutable uint64_t m_SampleNodes = 0;
+    mutable double m_NodesPerSecond = 0.0;
+};
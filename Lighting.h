@@ -0,0 +1,852 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <vector>
+#include <glm/glm.hpp>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "Chunk.h"
+#include "Block.h"
+#include "LightQueue.h"
+
+struct LightUpdateNode {
+    glm::ivec3 pos;
+    unsigned char level;
+};
+
+// A block edit whose light still has to be updated.
+struct LightUpdateJob {
+    glm::ivec3 pos;
+    BlockID oldBlock;
+    BlockID newBlock;
+    // Height of the edited column (see BasicChunk::getHeight) before and after the edit.
+    int oldHeight;
+    int newHeight;
+};
+
+// The original initial-light kernel, stepping through access for every voxel. Kept as the
+// reference LightBenchmark checks computeInitialLight against.
+template<typename ChunkT, typename Accessor>
+void computeInitialLightReference(ChunkT& chunk, Accessor& access) {
+    std::queue<LightUpdateNode> sunQueue;
+    std::queue<LightUpdateNode> blockQueue;
+
+    glm::ivec3 chunkWorldPos = chunk.m_Position * glm::ivec3(CHUNK_WIDTH, 0, CHUNK_DEPTH);
+
+    std::vector<unsigned char> blocks(CHUNK_VOLUME);
+    chunk.getBlocks(blocks.data());
+
+    // Empty sections above the terrain are fully sky-lit. Fill them in bulk and only seed
+    // their outer faces, since every inner neighbour is already at 15.
+    int skyStartY = CHUNK_HEIGHT;
+    while (skyStartY > 0 && chunk.isSectionEmpty(skyStartY / SECTION_HEIGHT - 1)) {
+        skyStartY -= SECTION_HEIGHT;
+        chunk.fillSectionLight(skyStartY / SECTION_HEIGHT, 15, 0);
+    }
+    for (int y = skyStartY; y < CHUNK_HEIGHT; ++y) {
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                if (x == 0 || x == CHUNK_WIDTH - 1 || z == 0 || z == CHUNK_DEPTH - 1) {
+                    sunQueue.push({ chunkWorldPos + glm::ivec3(x, y, z), 15 });
+                }
+            }
+        }
+    }
+
+    for (int x = 0; x < CHUNK_WIDTH; ++x) {
+        for (int z = 0; z < CHUNK_DEPTH; ++z) {
+            bool skyVisible = true;
+            for (int y = skyStartY - 1; y >= 0; --y) {
+                BlockID currentBlock = (BlockID)blocks[ChunkT::getIndex(x, y, z)];
+                if (skyVisible) {
+                    if (BlockDataManager::isTransparentForLighting(currentBlock)) {
+                        chunk.setSunlight(x, y, z, 15);
+                        sunQueue.push({ chunkWorldPos + glm::ivec3(x, y, z), 15 });
+                    }
+                    else {
+                        chunk.setSunlight(x, y, z, 0);
+                        skyVisible = false;
+                    }
+                }
+                else {
+                    chunk.setSunlight(x, y, z, 0);
+                }
+
+                const auto& blockData = BlockDataManager::getData(currentBlock);
+                if (blockData.emissionStrength > 0) {
+                    chunk.setBlockLight(x, y, z, blockData.emissionStrength);
+                    blockQueue.push({ chunkWorldPos + glm::ivec3(x, y, z), blockData.emissionStrength });
+                }
+                else {
+                    chunk.setBlockLight(x, y, z, 0);
+                }
+            }
+        }
+    }
+
+    while (!sunQueue.empty()) {
+        LightUpdateNode node = sunQueue.front();
+        sunQueue.pop();
+        if (node.level <= 1) continue;
+
+        for (const auto& offset : { glm::ivec3(0,-1,0), glm::ivec3(0,1,0), glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
+            glm::ivec3 nPos = node.pos + offset;
+            bool isDownward = offset.y == -1;
+            unsigned char propagatedLight = (isDownward && node.level == 15) ? 15 : node.level - 1;
+
+            if (propagatedLight > 0 && BlockDataManager::isTransparentForLighting((BlockID)access.getBlock(nPos.x, nPos.y, nPos.z)) && access.getSunlight(nPos.x, nPos.y, nPos.z) < propagatedLight) {
+                access.setSunlight(nPos.x, nPos.y, nPos.z, propagatedLight);
+                sunQueue.push({ nPos, propagatedLight });
+            }
+        }
+    }
+
+    while (!blockQueue.empty()) {
+        LightUpdateNode node = blockQueue.front();
+        blockQueue.pop();
+        if (node.level <= 1) continue;
+
+        for (const auto& offset : { glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
+            glm::ivec3 nPos = node.pos + offset;
+            if (BlockDataManager::isTransparentForLighting((BlockID)access.getBlock(nPos.x, nPos.y, nPos.z)) && access.getBlockLight(nPos.x, nPos.y, nPos.z) < node.level - 1) {
+                access.setBlockLight(nPos.x, nPos.y, nPos.z, node.level - 1);
+                blockQueue.push({ nPos, (unsigned char)(node.level - 1) });
+            }
+        }
+    }
+}
+
+// One row of a chunk's light, CHUNK_DEPTH levels along z, for PaddedLightVolume's vector
+// passes. Levels never exceed 15, so the byte arithmetic never wraps.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+struct LightRowSse2 {
+    using V = __m128i;
+
+    static V load(const unsigned char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(unsigned char* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V zero() { return _mm_setzero_si128(); }
+    static V set1(unsigned char v) { return _mm_set1_epi8(static_cast<char>(v)); }
+    static V max(V a, V b) { return _mm_max_epu8(a, b); }
+    // 15 where a >= b, else 0.
+    static V fullIfAtLeast(V a, V b) { return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(a, b), a), set1(15)); }
+    // What each level passes to a neighbour: one less, but 15 stays 15 going down.
+    static V spread(V v) { return _mm_subs_epu8(v, set1(1)); }
+    static V spreadDown(V v) { return _mm_sub_epi8(spread(v), _mm_cmpeq_epi8(v, set1(15))); }
+    // v where transparent is non-zero, else 0.
+    static V keepTransparent(V v, V transparent) { return _mm_andnot_si128(_mm_cmpeq_epi8(transparent, zero()), v); }
+    // The row moved one voxel towards higher z, or lower z, with 0 shifted in.
+    static V fromLowerZ(V v) { return _mm_slli_si128(v, 1); }
+    static V fromHigherZ(V v) { return _mm_srli_si128(v, 1); }
+    static bool equal(V a, V b) { return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF; }
+};
+using LightRow = LightRowSse2;
+static_assert(CHUNK_DEPTH == 16, "LightRowSse2 holds a row of 16 levels");
+#else
+struct LightRowScalar {
+    struct V { unsigned char level[CHUNK_DEPTH]; };
+
+    static V load(const unsigned char* p) { V v; std::memcpy(v.level, p, CHUNK_DEPTH); return v; }
+    static void store(unsigned char* p, const V& v) { std::memcpy(p, v.level, CHUNK_DEPTH); }
+    static V zero() { return set1(0); }
+    static V set1(unsigned char level) { V v; std::memset(v.level, level, CHUNK_DEPTH); return v; }
+    template<typename F>
+    static V map(const V& a, const V& b, F f) {
+        V v;
+        for (int z = 0; z < CHUNK_DEPTH; ++z) v.level[z] = f(a.level[z], b.level[z]);
+        return v;
+    }
+    static V max(const V& a, const V& b) { return map(a, b, [](unsigned char x, unsigned char y) { return std::max(x, y); }); }
+    static V fullIfAtLeast(const V& a, const V& b) { return map(a, b, [](unsigned char x, unsigned char y) { return x >= y ? 15 : 0; }); }
+    static V spread(const V& v) { return map(v, v, [](unsigned char x, unsigned char) { return x > 0 ? x - 1 : 0; }); }
+    static V spreadDown(const V& v) { return map(v, v, [](unsigned char x, unsigned char) { return x == 15 ? 15 : (x > 0 ? x - 1 : 0); }); }
+    static V keepTransparent(const V& v, const V& transparent) { return map(v, transparent, [](unsigned char x, unsigned char t) { return t ? x : 0; }); }
+    static V fromLowerZ(const V& v) { V out = zero(); std::memcpy(out.level + 1, v.level, CHUNK_DEPTH - 1); return out; }
+    static V fromHigherZ(const V& v) { V out = zero(); std::memcpy(out.level, v.level + 1, CHUNK_DEPTH - 1); return out; }
+    static bool equal(const V& a, const V& b) { return std::memcmp(a.level, b.level, CHUNK_DEPTH) == 0; }
+};
+using LightRow = LightRowScalar;
+#endif
+
+// Working copy of a chunk and LIGHT_PADDING blocks of its neighbours for computeInitialLight.
+// Light from the chunk fades out within 14 blocks, so the flood never leaves the padding.
+// Voxels are in [x][y][z] order with an opaque layer above and below the column, so a step
+// is one add and the flood needs no bounds checks.
+struct PaddedLightVolume {
+    static const int LIGHT_PADDING = 15;
+    static const int WIDTH = CHUNK_WIDTH + 2 * LIGHT_PADDING;
+    static const int HEIGHT = CHUNK_HEIGHT + 2;
+    static const int DEPTH = CHUNK_DEPTH + 2 * LIGHT_PADDING;
+    static const int VOLUME = WIDTH * HEIGHT * DEPTH;
+    static const int STEP_X = HEIGHT * DEPTH;
+    static const int STEP_Y = DEPTH;
+    static const int STEP_Z = 1;
+
+    // x and z relative to the chunk's origin, y in world space.
+    static int getIndex(int x, int y, int z) {
+        return ((x + LIGHT_PADDING) * HEIGHT + y + 1) * DEPTH + z + LIGHT_PADDING;
+    }
+
+    // Index into heights of column (x, z), x and z from -1 to the chunk's size.
+    static int getColumn(int x, int z) { return (x + 1) * (CHUNK_DEPTH + 2) + z + 1; }
+
+    // Range of local coordinates of the neighbour offset chunks away that lie in the volume.
+    static int getStart(int offset, int size) { return std::max(0, -LIGHT_PADDING - offset * size); }
+    static int getEnd(int offset, int size) { return std::min(size, LIGHT_PADDING + size - offset * size); }
+
+    std::vector<unsigned char> transparent = std::vector<unsigned char>(VOLUME);
+    std::vector<unsigned char> sunlight = std::vector<unsigned char>(VOLUME);
+    std::vector<unsigned char> blockLight = std::vector<unsigned char>(VOLUME);
+    // Packed light of each voxel as loaded, to find what changed.
+    std::vector<unsigned char> original = std::vector<unsigned char>(VOLUME);
+    // 1 outside the chunk being lit.
+    std::vector<unsigned char> outside = std::vector<unsigned char>(VOLUME, 1);
+    // Heights (see BasicChunk::getHeight) of the chunk's columns and of the side neighbours'
+    // columns along its edges, by getColumn.
+    std::array<int, (CHUNK_WIDTH + 2) * (CHUNK_DEPTH + 2)> heights{};
+    // The chunk's own heights again as bytes, [x][z], one LightRow per x.
+    std::array<unsigned char, CHUNK_WIDTH * CHUNK_DEPTH> centerHeights{};
+    // Lowest and highest y seed() queued sunlight at, and of the chunk's emitters; bottom >
+    // top if none.
+    int sunSeedBottom = 0;
+    int sunSeedTop = -1;
+    int emitterBottom = 0;
+    int emitterTop = -1;
+    // Flood queue and emitter entries are index << 4 | level.
+    LightQueue sunQueue;
+    LightQueue blockQueue;
+    std::vector<uint32_t> emitters;
+    std::vector<unsigned char> denseBlocks = std::vector<unsigned char>(CHUNK_VOLUME);
+    std::vector<unsigned char> denseLight = std::vector<unsigned char>(CHUNK_VOLUME);
+    // Emission strength by block id, looked up the first time an id is seen; only registered
+    // ids have block data.
+    static constexpr unsigned char UNKNOWN_EMISSION = 0xFF;
+    std::array<unsigned char, 256> emission;
+
+    PaddedLightVolume() {
+        emission.fill(UNKNOWN_EMISSION);
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+                std::memset(&outside[getIndex(x, y, 0)], 0, CHUNK_DEPTH);
+            }
+        }
+    }
+
+    // Loads the blocks and light of the chunk being lit and collects its light sources.
+    template<typename ChunkT>
+    void loadCenter(const ChunkT& chunk) {
+        const BlockTable& table = getBlockTable();
+        chunk.getBlocks(denseBlocks.data());
+        chunk.getLightLevels(denseLight.data());
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                heights[getColumn(x, z)] = chunk.getHeight(x, z);
+                centerHeights[x * CHUNK_DEPTH + z] = static_cast<unsigned char>(chunk.getHeight(x, z));
+            }
+        }
+        emitters.clear();
+        emitterBottom = CHUNK_HEIGHT;
+        emitterTop = -1;
+        for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+            unsigned char uniformBlock = 0;
+            const bool uniform = chunk.isSectionUniform(sy, uniformBlock);
+            for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                for (int y = sy * SECTION_HEIGHT; y < (sy + 1) * SECTION_HEIGHT; ++y) {
+                    const int row = getIndex(x, y, 0);
+                    const unsigned char* blocks = &denseBlocks[ChunkT::getIndex(x, y, 0)];
+                    std::memcpy(&original[row], &denseLight[ChunkT::getIndex(x, y, 0)], CHUNK_DEPTH);
+                    if (uniform) {
+                        std::memset(&transparent[row], table.transparent[uniformBlock], CHUNK_DEPTH);
+                        if (getEmission(uniformBlock) == 0) continue;
+                    }
+                    else {
+                        for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                            transparent[row + z] = table.transparent[blocks[z]];
+                        }
+                    }
+                    for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                        const unsigned char strength = getEmission(blocks[z]);
+                        if (strength > 0) {
+                            emitters.push_back(static_cast<uint32_t>(row + z) << 4 | strength);
+                            emitterBottom = std::min(emitterBottom, y);
+                            emitterTop = std::max(emitterTop, y);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Loads the part of the neighbour at chunk offset (cx, cz) with local x in [x0, x1), y in
+    // [y0, y1) and z in [z0, z1). A missing neighbour reads like it does through the
+    // accessor: air that sunlight can't raise above 15 and that keeps no block light.
+    template<typename ChunkT>
+    void loadNeighbor(const ChunkT* neighbor, int cx, int cz, int x0, int x1, int y0, int y1, int z0, int z1) {
+        const BlockTable& table = getBlockTable();
+        if (neighbor) {
+            neighbor->getBlocks(denseBlocks.data(), x0, x1, y0, y1, z0, z1);
+            neighbor->getLightLevels(denseLight.data(), x0, x1, y0, y1, z0, z1);
+        }
+        for (int x = x0; x < x1; ++x) {
+            for (int y = y0; y < y1; ++y) {
+                const int row = getIndex(cx * CHUNK_WIDTH + x, y, cz * CHUNK_DEPTH);
+                if (!neighbor) {
+                    std::memset(&transparent[row + z0], 1, z1 - z0);
+                    std::memset(&sunlight[row + z0], 15, z1 - z0);
+                    std::memset(&blockLight[row + z0], 0, z1 - z0);
+                    std::memset(&original[row + z0], IMPLICIT_SECTION_LIGHT, z1 - z0);
+                    continue;
+                }
+                const unsigned char* blocks = &denseBlocks[ChunkT::getIndex(x, y, 0)];
+                const unsigned char* light = &denseLight[ChunkT::getIndex(x, y, 0)];
+                for (int z = z0; z < z1; ++z) {
+                    transparent[row + z] = table.transparent[blocks[z]];
+                    sunlight[row + z] = light[z] >> 4;
+                    blockLight[row + z] = light[z] & 0x0F;
+                    original[row + z] = light[z];
+                }
+            }
+        }
+    }
+
+    // Records the heights of the side neighbour at chunk offset (cx, cz) along the chunk's
+    // edge; a missing neighbour is open sky.
+    template<typename ChunkT>
+    void loadEdgeHeights(const ChunkT* neighbor, int cx, int cz) {
+        for (int i = 0; i < CHUNK_WIDTH; ++i) {
+            const int x = cx == 0 ? i : (cx < 0 ? CHUNK_WIDTH - 1 : 0);
+            const int z = cz == 0 ? i : (cz < 0 ? CHUNK_DEPTH - 1 : 0);
+            heights[getColumn(cx * CHUNK_WIDTH + x, cz * CHUNK_DEPTH + z)] = neighbor ? neighbor->getHeight(x, z) : 0;
+        }
+    }
+
+    // Resets the chunk's own light and queues its sources, as computeInitialLightReference
+    // seeds it: full sunlight from each column's height up, none below.
+    void seed() {
+        sunQueue.clear();
+        blockQueue.clear();
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            const LightRow::V columnHeights = LightRow::load(&centerHeights[x * CHUNK_DEPTH]);
+            for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+                const int row = getIndex(x, y, 0);
+                std::memset(&blockLight[row], 0, CHUNK_DEPTH);
+                LightRow::store(&sunlight[row], LightRow::fullIfAtLeast(LightRow::set1(static_cast<unsigned char>(y)), columnHeights));
+            }
+        }
+
+        // The reference floods from every sky-lit voxel, but above and below one is sky-lit
+        // or opaque, and beside one is only dimmer below a taller neighbouring column. So only
+        // the voxels between a column's height and its tallest side neighbour's are seeded.
+        const int sides[4] = { STEP_X, -STEP_X, STEP_Z, -STEP_Z };
+        sunSeedBottom = CHUNK_HEIGHT;
+        sunSeedTop = -1;
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                const int top = std::max(std::max(heights[getColumn(x + 1, z)], heights[getColumn(x - 1, z)]),
+                    std::max(heights[getColumn(x, z + 1)], heights[getColumn(x, z - 1)]));
+                for (int y = heights[getColumn(x, z)]; y < top; ++y) {
+                    const int index = getIndex(x, y, z);
+                    for (int side : sides) {
+                        if (transparent[index + side] && sunlight[index + side] < 14) {
+                            sunQueue.push(static_cast<uint32_t>(index) << 4 | 15);
+                            sunSeedBottom = std::min(sunSeedBottom, y);
+                            sunSeedTop = std::max(sunSeedTop, y);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (uint32_t emitter : emitters) {
+            blockLight[emitter >> 4] = emitter & 0x0F;
+            blockQueue.push(emitter);
+        }
+    }
+
+    // The heights of the neighbours that seeding and spreading the chunk's light can read,
+    // once loadCenter and loadEdgeHeights have run. seed() only queues sunlight between a
+    // column's height and its tallest side neighbour's, and below the sky light is at most
+    // 14 and loses a level every step, so nothing more than 14 blocks above or below that
+    // or an emitter is read. Empty if there is nothing to spread.
+    void getReachRange(int& y0, int& y1) const {
+        int bottom = emitterBottom;
+        int top = emitterTop;
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                const int height = heights[getColumn(x, z)];
+                const int sideTop = std::max(std::max(heights[getColumn(x + 1, z)], heights[getColumn(x - 1, z)]),
+                    std::max(heights[getColumn(x, z + 1)], heights[getColumn(x, z - 1)]));
+                if (height < sideTop) {
+                    bottom = std::min(bottom, height);
+                    top = std::max(top, sideTop - 1);
+                }
+            }
+        }
+        y0 = std::max(0, bottom - 14);
+        y1 = std::min(CHUNK_HEIGHT, top + 15);
+    }
+
+    // The same for the sunlight seed() actually queued, which is usually less.
+    void getSeededRange(int& y0, int& y1) const {
+        y0 = std::max(0, std::min(sunSeedBottom, emitterBottom) - 14);
+        y1 = std::min(CHUNK_HEIGHT, std::max(sunSeedTop, emitterTop) + 15);
+    }
+
+    // Spreads the seeded sunlight through the chunk a row at a time: each sweep lets every
+    // voxel take the brightest level its neighbours pass on, until a sweep changes nothing.
+    // That is the same fixed point flooding sunQueue reaches, as voxels lit from the sky
+    // without being queued are ones nothing can brighten. Returns false if the light would
+    // spread outside the chunk.
+    bool sweepSunlight() {
+        using Row = LightRow;
+        if (sunSeedTop < sunSeedBottom) return true;
+        // Below the sky sunlight is at most 14 and loses a level every step, so it never
+        // changes more than 14 blocks above or below a seed.
+        const int bottom = std::max(0, sunSeedBottom - 14);
+        const int top = std::min(CHUNK_HEIGHT, sunSeedTop + 15);
+
+        // Alternating directions carries light along a whole run of voxels in one sweep
+        // whichever way the run goes.
+        bool forward = true;
+        for (bool changed = true; changed; forward = !forward) {
+            changed = false;
+            for (int i = 0; i < CHUNK_WIDTH; ++i) {
+                const int x = forward ? i : CHUNK_WIDTH - 1 - i;
+                for (int j = bottom; j < top; ++j) {
+                    const int y = forward ? top - 1 - (j - bottom) : j;
+                    const int row = getIndex(x, y, 0);
+                    const Row::V current = Row::load(&sunlight[row]);
+                    Row::V passed = Row::max(Row::spread(Row::fromLowerZ(current)), Row::spread(Row::fromHigherZ(current)));
+                    if (x > 0) passed = Row::max(passed, Row::spread(Row::load(&sunlight[row - STEP_X])));
+                    if (x < CHUNK_WIDTH - 1) passed = Row::max(passed, Row::spread(Row::load(&sunlight[row + STEP_X])));
+                    if (y > 0) passed = Row::max(passed, Row::spread(Row::load(&sunlight[row - STEP_Y])));
+                    if (y < CHUNK_HEIGHT - 1) passed = Row::max(passed, Row::spreadDown(Row::load(&sunlight[row + STEP_Y])));
+                    const Row::V lit = Row::max(current, Row::keepTransparent(passed, Row::load(&transparent[row])));
+                    if (!Row::equal(lit, current)) {
+                        Row::store(&sunlight[row], lit);
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        auto escapes = [&](int row, int neighbor) {
+            const Row::V passed = Row::keepTransparent(Row::spread(Row::load(&sunlight[row])), Row::load(&transparent[neighbor]));
+            const Row::V outside = Row::load(&sunlight[neighbor]);
+            return !Row::equal(Row::max(passed, outside), outside);
+        };
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int y = bottom; y < top; ++y) {
+                const int row = getIndex(x, y, 0);
+                if (x == 0 && escapes(row, row - STEP_X)) return false;
+                if (x == CHUNK_WIDTH - 1 && escapes(row, row + STEP_X)) return false;
+                const int last = row + CHUNK_DEPTH - 1;
+                if (transparent[row - STEP_Z] && sunlight[row] > sunlight[row - STEP_Z] + 1) return false;
+                if (transparent[last + STEP_Z] && sunlight[last] > sunlight[last + STEP_Z] + 1) return false;
+            }
+        }
+        return true;
+    }
+
+    // Spreads the queued light. With contained set, sunlight is swept instead of flooded, and
+    // this stops and returns false as soon as light would change a voxel outside the chunk.
+    bool flood(bool contained) {
+        if (contained) {
+            if (!sweepSunlight()) return false;
+            sunQueue.clear();
+        }
+        // Down first, so full sunlight is the only case that doesn't lose a level.
+        const int steps[6] = { -STEP_Y, STEP_Y, STEP_X, -STEP_X, STEP_Z, -STEP_Z };
+        while (!sunQueue.empty()) {
+            const uint32_t node = sunQueue.pop();
+            const int index = static_cast<int>(node >> 4);
+            const unsigned char level = node & 0x0F;
+            if (level <= 1) continue;
+            for (int i = 0; i < 6; ++i) {
+                const unsigned char propagated = (i == 0 && level == 15) ? 15 : level - 1;
+                const int next = index + steps[i];
+                if (transparent[next] && sunlight[next] < propagated) {
+                    if (contained && outside[next]) return false;
+                    sunlight[next] = propagated;
+                    sunQueue.push(static_cast<uint32_t>(next) << 4 | propagated);
+                }
+            }
+        }
+
+        while (!blockQueue.empty()) {
+            const uint32_t node = blockQueue.pop();
+            const int index = static_cast<int>(node >> 4);
+            const unsigned char level = node & 0x0F;
+            if (level <= 1) continue;
+            for (int i = 0; i < 6; ++i) {
+                const int next = index + steps[i];
+                if (transparent[next] && blockLight[next] < level - 1) {
+                    if (contained && outside[next]) return false;
+                    blockLight[next] = level - 1;
+                    blockQueue.push(static_cast<uint32_t>(next) << 4 | (level - 1));
+                }
+            }
+        }
+        sunQueue.clear();
+        blockQueue.clear();
+        return true;
+    }
+
+    // Writes back the voxels of the neighbour at chunk offset (cx, cz) with y in [y0, y1)
+    // whose light changed.
+    template<typename ChunkT>
+    void commitNeighbor(ChunkT& neighbor, int cx, int cz, int y0, int y1) const {
+        const int z0 = getStart(cz, CHUNK_DEPTH);
+        const int z1 = getEnd(cz, CHUNK_DEPTH);
+        for (int x = getStart(cx, CHUNK_WIDTH); x < getEnd(cx, CHUNK_WIDTH); ++x) {
+            for (int y = y0; y < y1; ++y) {
+                const int row = getIndex(cx * CHUNK_WIDTH + x, y, cz * CHUNK_DEPTH);
+                for (int z = z0; z < z1; ++z) {
+                    const unsigned char packed = static_cast<unsigned char>(sunlight[row + z] << 4 | blockLight[row + z]);
+                    if (packed == original[row + z]) continue;
+                    neighbor.setSunlight(x, y, z, packed >> 4);
+                    neighbor.setBlockLight(x, y, z, packed & 0x0F);
+                }
+            }
+        }
+    }
+
+    // Writes back the chunk's own light in one bulk copy, if any of it changed.
+    template<typename ChunkT>
+    void commitCenter(ChunkT& chunk) {
+        unsigned char changed = 0;
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+                const int row = getIndex(x, y, 0);
+                unsigned char* dense = &denseLight[ChunkT::getIndex(x, y, 0)];
+                for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                    dense[z] = static_cast<unsigned char>(sunlight[row + z] << 4 | blockLight[row + z]);
+                    changed |= dense[z] ^ original[row + z];
+                }
+            }
+        }
+        if (changed) {
+            chunk.setLightLevels(denseLight.data());
+        }
+    }
+
+private:
+    unsigned char getEmission(unsigned char block) {
+        if (emission[block] == UNKNOWN_EMISSION) {
+            emission[block] = BlockDataManager::getData(static_cast<BlockID>(block)).emissionStrength;
+        }
+        return emission[block];
+    }
+
+    struct BlockTable {
+        unsigned char transparent[256];
+        BlockTable() {
+            for (int id = 0; id < 256; ++id) {
+                transparent[id] = BlockDataManager::isTransparentForLighting(static_cast<BlockID>(id)) ? 1 : 0;
+            }
+        }
+    };
+
+    static const BlockTable& getBlockTable() {
+        static const BlockTable table;
+        return table;
+    }
+};
+
+// Computes sky and block light for a freshly generated chunk. Light spills into loaded
+// neighbours, which access resolves. Gives the same light as computeInitialLightReference,
+// but floods a PaddedLightVolume and writes back only what changed.
+// Most relights change nothing outside the chunk, so the light is first spread with only a
+// one-block ring of the neighbours loaded, sunlight by sweeping whole rows; the rest of the
+// padding is only loaded, and everything flooded voxel by voxel, once light reaches into a
+// neighbour.
+template<typename ChunkT, typename Accessor>
+void computeInitialLight(ChunkT& chunk, Accessor& access) {
+    using Volume = PaddedLightVolume;
+    static thread_local Volume volume;
+
+    const int baseX = chunk.m_Position.x * CHUNK_WIDTH;
+    const int baseZ = chunk.m_Position.z * CHUNK_DEPTH;
+    std::array<ChunkT*, 9> neighbors{};
+    for (int cx = -1; cx <= 1; ++cx) {
+        for (int cz = -1; cz <= 1; ++cz) {
+            if (cx == 0 && cz == 0) continue;
+            neighbors[(cx + 1) * 3 + cz + 1] = access.getChunk(baseX + cx * CHUNK_WIDTH, baseZ + cz * CHUNK_DEPTH);
+        }
+    }
+
+    volume.loadCenter(chunk);
+    for (int cx = -1; cx <= 1; ++cx) {
+        for (int cz = -1; cz <= 1; ++cz) {
+            if ((cx == 0) != (cz == 0)) volume.loadEdgeHeights(neighbors[(cx + 1) * 3 + cz + 1], cx, cz);
+        }
+    }
+    // Only the heights the light can reach are loaded from the neighbours; the rest of the
+    // padding keeps whatever an earlier chunk left there, which is never read.
+    int y0, y1;
+    volume.getReachRange(y0, y1);
+    // A voxel of the chunk only touches the four side neighbours, one block deep.
+    for (int cx = -1; cx <= 1; ++cx) {
+        for (int cz = -1; cz <= 1; ++cz) {
+            if ((cx == 0) == (cz == 0)) continue;
+            const int x0 = cx < 0 ? CHUNK_WIDTH - 1 : 0;
+            const int z0 = cz < 0 ? CHUNK_DEPTH - 1 : 0;
+            const int x1 = cx > 0 ? 1 : CHUNK_WIDTH;
+            const int z1 = cz > 0 ? 1 : CHUNK_DEPTH;
+            volume.loadNeighbor(neighbors[(cx + 1) * 3 + cz + 1], cx, cz, x0, x1, y0, y1, z0, z1);
+        }
+    }
+    volume.seed();
+
+    if (!volume.flood(true)) {
+        volume.getSeededRange(y0, y1);
+        for (int cx = -1; cx <= 1; ++cx) {
+            for (int cz = -1; cz <= 1; ++cz) {
+                if (cx == 0 && cz == 0) continue;
+                volume.loadNeighbor(neighbors[(cx + 1) * 3 + cz + 1], cx, cz,
+                    Volume::getStart(cx, CHUNK_WIDTH), Volume::getEnd(cx, CHUNK_WIDTH), y0, y1,
+                    Volume::getStart(cz, CHUNK_DEPTH), Volume::getEnd(cz, CHUNK_DEPTH));
+            }
+        }
+        volume.seed();
+        volume.flood(false);
+        for (int cx = -1; cx <= 1; ++cx) {
+            for (int cz = -1; cz <= 1; ++cz) {
+                ChunkT* neighbor = neighbors[(cx + 1) * 3 + cz + 1];
+                if (neighbor) {
+                    volume.commitNeighbor(*neighbor, cx, cz, y0, y1);
+                }
+            }
+        }
+    }
+    volume.commitCenter(chunk);
+}
+
+// Updates block light and sunlight after a batch of edits, given in the order they were
+// made and already applied to the blocks. All edits share one removal and one propagation
+// flood, so filling or clearing a region costs about one flood over the region instead of
+// one per block. Seeds are taken from the light as it was before the batch and the blocks
+// as they are now: light is first taken out around every edit that may have carried it,
+// then spread back in from what remains, from new emitters and from opened sky. Adds the
+// chunk of every edit and every chunk whose light changed to changedChunks.
+template<typename Accessor, typename ChunkSet>
+void updateLight(const std::vector<LightUpdateJob>& updates, Accessor& access, ChunkSet& changedChunks) {
+    // Down first, matching computeInitialLightReference.
+    const glm::ivec3 offsets[6] = { {0,-1,0}, {0,1,0}, {1,0,0}, {-1,0,0}, {0,0,1}, {0,0,-1} };
+    auto getChunkPos = [](const glm::ivec3& pos) {
+        return glm::ivec3(pos.x >> CHUNK_WIDTH_SHIFT, 0, pos.z >> CHUNK_DEPTH_SHIFT);
+    };
+    auto isTransparent = [&](const glm::ivec3& pos) {
+        return BlockDataManager::isTransparentForLighting(static_cast<BlockID>(access.getBlock(pos.x, pos.y, pos.z)));
+    };
+    // 28 bits each of x and z, 8 of y.
+    auto getPosKey = [](const glm::ivec3& pos) {
+        return (static_cast<uint64_t>(pos.x & 0xFFFFFFF) << 36) | (static_cast<uint64_t>(pos.z & 0xFFFFFFF) << 8) | static_cast<uint64_t>(pos.y & 0xFF);
+    };
+
+    // Each edited column's height before its first edit and after its last.
+    struct ColumnChange {
+        int x;
+        int z;
+        int oldHeight;
+        int newHeight;
+    };
+
+    // Reused by every update on this thread, so floods and the batch's bookkeeping stop
+    // allocating once warmed up.
+    struct Queues {
+        LightQueue removal;
+        LightQueue propagation;
+        LightNodePacker packer;
+        LightKeyIndex edited;
+        LightKeyIndex columnIndex;
+        std::vector<ColumnChange> columns;
+    };
+    static thread_local Queues queues;
+    LightNodePacker& packer = queues.packer;
+    packer.reset();
+
+    LightKeyIndex& edited = queues.edited;
+    LightKeyIndex& columnIndex = queues.columnIndex;
+    std::vector<ColumnChange>& columns = queues.columns;
+    edited.clear();
+    columnIndex.clear();
+    columns.clear();
+    for (const auto& update : updates) {
+        changedChunks.insert(getChunkPos(update.pos));
+        edited.insert(getPosKey(update.pos));
+        uint32_t column = columnIndex.insert(getPosKey({ update.pos.x, 0, update.pos.z }));
+        if (column == columns.size()) {
+            columns.push_back({ update.pos.x, update.pos.z, update.oldHeight, update.newHeight });
+        }
+        else {
+            columns[column].newHeight = update.newHeight;
+        }
+    }
+    auto push = [&](LightQueue& queue, const glm::ivec3& pos, unsigned char level) {
+        queue.push(packer.pack(pos, level));
+    };
+    auto pop = [&](LightQueue& queue) {
+        uint32_t node = queue.pop();
+        return LightUpdateNode{ packer.getPosition(node), LightNodePacker::getLevel(node) };
+    };
+    // Nothing is stored above or below the world, so it is never queued.
+    auto isInWorld = [](const glm::ivec3& pos) { return pos.y >= 0 && pos.y < CHUNK_HEIGHT; };
+
+    // Light may now spread into an opened voxel from any lit neighbour. Edited neighbours
+    // seed themselves, so a batch filling or clearing a region only seeds from its surface.
+    auto seedFrom = [&](const glm::ivec3& pos, auto getLight, LightQueue& queue) {
+        unsigned char light = getLight(pos);
+        if (light > 0) push(queue, pos, light);
+        for (const auto& offset : offsets) {
+            glm::ivec3 nPos = pos + offset;
+            if (!isInWorld(nPos) || edited.contains(getPosKey(nPos))) continue;
+            light = getLight(nPos);
+            if (light > 0) push(queue, nPos, light);
+        }
+    };
+
+    {
+        LightQueue& removalQueue = queues.removal;
+        LightQueue& propagationQueue = queues.propagation;
+
+        // Whatever an edited voxel emitted or passed on may be gone now.
+        for (const auto& update : updates) {
+            unsigned char level = access.getBlockLight(update.pos.x, update.pos.y, update.pos.z);
+            if (level > 0) {
+                access.setBlockLight(update.pos.x, update.pos.y, update.pos.z, 0);
+                push(removalQueue, update.pos, level);
+            }
+        }
+
+        while (!removalQueue.empty()) {
+            LightUpdateNode node = pop(removalQueue);
+            changedChunks.insert(getChunkPos(node.pos));
+
+            for (const auto& offset : offsets) {
+                glm::ivec3 nPos = node.pos + offset;
+                unsigned char neighborLevel = access.getBlockLight(nPos.x, nPos.y, nPos.z);
+                if (neighborLevel != 0) {
+                    if (neighborLevel < node.level) {
+                        access.setBlockLight(nPos.x, nPos.y, nPos.z, 0);
+                        push(removalQueue, nPos, neighborLevel);
+                    }
+                    else {
+                        push(propagationQueue, nPos, neighborLevel);
+                    }
+                }
+            }
+        }
+
+        for (const auto& update : updates) {
+            const glm::ivec3& pos = update.pos;
+            unsigned char emission = BlockDataManager::getData(static_cast<BlockID>(access.getBlock(pos.x, pos.y, pos.z))).emissionStrength;
+            if (emission > access.getBlockLight(pos.x, pos.y, pos.z)) {
+                access.setBlockLight(pos.x, pos.y, pos.z, emission);
+                push(propagationQueue, pos, emission);
+            }
+            if (isTransparent(pos)) seedFrom(pos, [&](const glm::ivec3& p) { return access.getBlockLight(p.x, p.y, p.z); }, propagationQueue);
+        }
+
+        while (!propagationQueue.empty()) {
+            LightUpdateNode node = pop(propagationQueue);
+            // Queued before a later removal or a brighter source reached it.
+            if (node.level <= 1 || access.getBlockLight(node.pos.x, node.pos.y, node.pos.z) != node.level) continue;
+            changedChunks.insert(getChunkPos(node.pos));
+
+            for (const auto& offset : offsets) {
+                glm::ivec3 nPos = node.pos + offset;
+                if (isInWorld(nPos) && isTransparent(nPos) && access.getBlockLight(nPos.x, nPos.y, nPos.z) < node.level - 1) {
+                    access.setBlockLight(nPos.x, nPos.y, nPos.z, node.level - 1);
+                    push(propagationQueue, nPos, node.level - 1);
+                }
+            }
+        }
+        removalQueue.clear();
+        propagationQueue.clear();
+    }
+
+    {
+        LightQueue& sunRemovalQueue = queues.removal;
+        LightQueue& sunPropagationQueue = queues.propagation;
+        auto removeSunlight = [&](const glm::ivec3& pos) {
+            unsigned char level = access.getSunlight(pos.x, pos.y, pos.z);
+            if (level > 0) {
+                access.setSunlight(pos.x, pos.y, pos.z, 0);
+                push(sunRemovalQueue, pos, level);
+            }
+        };
+
+        // Straight down an edited column, sunlight follows its height: what the batch
+        // covered loses full sunlight at once, instead of being walked one voxel at a time.
+        for (const auto& column : columns) {
+            for (int y = column.oldHeight; y < column.newHeight; ++y) {
+                removeSunlight({ column.x, y, column.z });
+            }
+        }
+        for (const auto& update : updates) {
+            if (!isTransparent(update.pos)) removeSunlight(update.pos);
+        }
+
+        while (!sunRemovalQueue.empty()) {
+            LightUpdateNode node = pop(sunRemovalQueue);
+            changedChunks.insert(getChunkPos(node.pos));
+
+            for (const auto& offset : offsets) {
+                glm::ivec3 nPos = node.pos + offset;
+                if (!isInWorld(nPos)) continue;
+                unsigned char neighborLevel = access.getSunlight(nPos.x, nPos.y, nPos.z);
+                if (neighborLevel > 0) {
+                    if (neighborLevel < node.level || (offset.y == -1 && node.level == 15)) {
+                        access.setSunlight(nPos.x, nPos.y, nPos.z, 0);
+                        push(sunRemovalQueue, nPos, neighborLevel);
+                    }
+                    else {
+                        push(sunPropagationQueue, nPos, neighborLevel);
+                    }
+                }
+            }
+        }
+
+        // What the batch uncovered gets full sunlight at once. It only has to spread sideways
+        // below the tallest neighbouring column; above that the sides are open sky already.
+        for (const auto& column : columns) {
+            if (column.newHeight >= column.oldHeight) continue;
+            int sideHeight = 0;
+            for (const auto& offset : { glm::ivec2(1,0), glm::ivec2(-1,0), glm::ivec2(0,1), glm::ivec2(0,-1) }) {
+                sideHeight = std::max(sideHeight, access.getHeight(column.x + offset.x, column.z + offset.y));
+            }
+            for (int y = column.newHeight; y < column.oldHeight; ++y) {
+                access.setSunlight(column.x, y, column.z, 15);
+                if (y < sideHeight) {
+                    push(sunPropagationQueue, { column.x, y, column.z }, 15);
+                }
+            }
+            changedChunks.insert(getChunkPos({ column.x, 0, column.z }));
+        }
+        for (const auto& update : updates) {
+            if (isTransparent(update.pos)) seedFrom(update.pos, [&](const glm::ivec3& p) { return access.getSunlight(p.x, p.y, p.z); }, sunPropagationQueue);
+        }
+
+        while (!sunPropagationQueue.empty()) {
+            LightUpdateNode node = pop(sunPropagationQueue);
+            if (node.level <= 1 || access.getSunlight(node.pos.x, node.pos.y, node.pos.z) != node.level) continue;
+            changedChunks.insert(getChunkPos(node.pos));
+
+            for (const auto& offset : offsets) {
+                glm::ivec3 nPos = node.pos + offset;
+                unsigned char propagatedLight = (offset.y == -1 && node.level == 15) ? 15 : node.level - 1;
+                if (isInWorld(nPos) && isTransparent(nPos) && access.getSunlight(nPos.x, nPos.y, nPos.z) < propagatedLight) {
+                    access.setSunlight(nPos.x, nPos.y, nPos.z, propagatedLight);
+                    push(sunPropagationQueue, nPos, propagatedLight);
+                }
+            }
+        }
+        sunRemovalQueue.clear();
+        sunPropagationQueue.clear();
+    }
+}
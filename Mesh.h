@@ -1,22 +1,28 @@
 #pragma once
 #include <vector>
+#include <cstddef>
+// Headless builds (VOXEL_HEADLESS) have no GL context: meshes keep their CPU geometry and
+// upload() only records what would have been sent.
+#if defined(VOXEL_HEADLESS)
+using GLsizei = int;
+#else
 #include <glad/glad.h>
+#endif
 
 struct Mesh {
     unsigned int VAO = 0, VBO = 0, EBO = 0;
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
+    // What the GL buffers hold, which stays valid after the CPU copy is released.
+    GLsizei indexCount = 0;
+    size_t gpuBytes = 0;
 
-    Mesh() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-    }
+    // GL objects are created on the first upload, so meshes can be built on worker
+    // threads and only the uploading (main) thread ever touches GL.
+    Mesh() = default;
 
     ~Mesh() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+        deleteBuffers();
     }
 
     Mesh(const Mesh&) = delete;
@@ -24,30 +30,74 @@ struct Mesh {
 
     Mesh(Mesh&& other) noexcept :
         VAO(other.VAO), VBO(other.VBO), EBO(other.EBO),
-        vertices(std::move(other.vertices)), indices(std::move(other.indices)) {
+        vertices(std::move(other.vertices)), indices(std::move(other.indices)),
+        indexCount(other.indexCount), gpuBytes(other.gpuBytes) {
         other.VAO = 0; other.VBO = 0; other.EBO = 0;
+        other.indexCount = 0; other.gpuBytes = 0;
     }
 
     Mesh& operator=(Mesh&& other) noexcept {
         if (this != &other) {
-            glDeleteVertexArrays(1, &VAO);
-            glDeleteBuffers(1, &VBO);
-            glDeleteBuffers(1, &EBO);
+            deleteBuffers();
 
             VAO = other.VAO;
             VBO = other.VBO;
             EBO = other.EBO;
             vertices = std::move(other.vertices);
             indices = std::move(other.indices);
+            indexCount = other.indexCount;
+            gpuBytes = other.gpuBytes;
 
             other.VAO = 0; other.VBO = 0; other.EBO = 0;
+            other.indexCount = 0; other.gpuBytes = 0;
         }
         return *this;
     }
 
 
+    // Drops the geometry but keeps the GL objects, so a pooled mesh can be reused
+    // without another round of glGen* calls.
+    void clear() {
+        releaseCpuData();
+        indexCount = 0;
+    }
+
+    // Frees the CPU copy of the geometry; draw() only needs what was uploaded.
+    void releaseCpuData() {
+        vertices.clear();
+        vertices.shrink_to_fit();
+        indices.clear();
+        indices.shrink_to_fit();
+    }
+
+    size_t getCpuMemoryUsage() const {
+        return vertices.capacity() * sizeof(float) + indices.capacity() * sizeof(unsigned int);
+    }
+
     void upload() {
-        if (vertices.empty()) return;
+        indexCount = static_cast<GLsizei>(indices.size());
+        if (vertices.empty()) {
+            // Give back what the previous upload held, so the memory budget stops counting it.
+#if !defined(VOXEL_HEADLESS)
+            if (VAO != 0) {
+                glBindVertexArray(VAO);
+                glBindBuffer(GL_ARRAY_BUFFER, VBO);
+                glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+                glBindVertexArray(0);
+            }
+#endif
+            gpuBytes = 0;
+            return;
+        }
+        gpuBytes = vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int);
+#if !defined(VOXEL_HEADLESS)
+        if (VAO == 0) {
+            glGenVertexArrays(1, &VAO);
+            glGenBuffers(1, &VBO);
+            glGenBuffers(1, &EBO);
+        }
 
         glBindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -73,12 +123,27 @@ struct Mesh {
         glEnableVertexAttribArray(4);
 
         glBindVertexArray(0);
+#endif
     }
 
     void draw() {
-        if (indices.empty()) return;
+#if !defined(VOXEL_HEADLESS)
+        if (indexCount == 0) return;
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
+#endif
+    }
+
+private:
+    void deleteBuffers() {
+#if !defined(VOXEL_HEADLESS)
+        if (VAO == 0) return;
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = 0; VBO = 0; EBO = 0;
+#endif
+        gpuBytes = 0;
     }
 };
\ No newline at end of file
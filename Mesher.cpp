@@ -12,40 +12,30 @@ const float ATLAS_HEIGHT_TILES = 16.0f;
 const float TILE_WIDTH_NORMALIZED = 1.0f / ATLAS_WIDTH_TILES;
 const float TILE_HEIGHT_NORMALIZED = 1.0f / ATLAS_HEIGHT_TILES;
 
-ChunkMeshingData::ChunkMeshingData(World& world, const glm::ivec3& centralChunkPos) {
-    m_LeafQuality = world.m_LeafQuality.load();
-    std::array<std::shared_ptr<const Chunk>, 9> neighbors{};
-    {
-        std::shared_lock<std::shared_mutex> lock(world.m_ChunksMutex);
-        int i = 0;
-        for (int z = -1; z <= 1; ++z) {
-            for (int x = -1; x <= 1; ++x) {
-                glm::ivec3 pos = centralChunkPos + glm::ivec3(x, 0, z);
-                auto it = world.m_Chunks.find(pos);
-                if (it != world.m_Chunks.end()) {
-                    neighbors[i] = it->second;
-                }
-                i++;
-            }
-        }
+template<typename ChunkT>
+ChunkMeshingData::ChunkMeshingData(const std::array<const ChunkT*, 9>& neighbors, LeafQuality leafQuality) {
+    m_LeafQuality = leafQuality;
+
+    for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+        m_SectionEmpty[sy] = !neighbors[4] || neighbors[4]->isSectionEmpty(sy);
     }
 
     if (neighbors[4]) { // Center chunk
-        const auto& center_chunk = neighbors[4];
-        for (int y = 0; y < CHUNK_HEIGHT; ++y) {
-            for (int z = 0; z < CHUNK_DEPTH; ++z) {
-                for (int x = 0; x < CHUNK_WIDTH; ++x) {
-                    m_Blocks[x + 1][y][z + 1] = center_chunk->getBlock(x, y, z);
-                    unsigned char sun = center_chunk->getSunlight(x, y, z);
-                    unsigned char block = center_chunk->getBlockLight(x, y, z);
-                    m_LightLevels[x + 1][y][z + 1] = (sun << 4) | block;
-                }
+        const ChunkT* center_chunk = neighbors[4];
+        std::vector<unsigned char> centerBlocks(CHUNK_VOLUME);
+        std::vector<unsigned char> centerLight(CHUNK_VOLUME);
+        center_chunk->getBlocks(centerBlocks.data());
+        center_chunk->getLightLevels(centerLight.data());
+        for (int x = 0; x < CHUNK_WIDTH; ++x) {
+            for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+                std::memcpy(&m_Blocks[x + 1][y][1], &centerBlocks[ChunkT::getIndex(x, y, 0)], CHUNK_DEPTH);
+                std::memcpy(&m_LightLevels[x + 1][y][1], &centerLight[ChunkT::getIndex(x, y, 0)], CHUNK_DEPTH);
             }
         }
     }
 
 
-    auto getNeighborLight = [&](const std::shared_ptr<const Chunk>& neighbor, int x, int y, int z) -> unsigned char {
+    auto getNeighborLight = [&](const ChunkT* neighbor, int x, int y, int z) -> unsigned char {
         if (!neighbor) return (15 << 4); // Full sun if no chunk
         unsigned char sun = neighbor->getSunlight(x, y, z);
         unsigned char block = neighbor->getBlockLight(x, y, z);
@@ -102,6 +92,12 @@ ChunkMeshingData::ChunkMeshingData(World& world, const glm::ivec3& centralChunkP
     }
 }
 
+template ChunkMeshingData::ChunkMeshingData(const std::array<const BasicChunk<XYZLayout>*, 9>&, LeafQuality);
+template ChunkMeshingData::ChunkMeshingData(const std::array<const BasicChunk<YXZLayout>*, 9>&, LeafQuality);
+template ChunkMeshingData::ChunkMeshingData(const std::array<const BasicChunk<XZYLayout>*, 9>&, LeafQuality);
+template ChunkMeshingData::ChunkMeshingData(const std::array<const BasicChunk<MortonLayout>*, 9>&, LeafQuality);
+template ChunkMeshingData::ChunkMeshingData(const std::array<const ChunkSnapshot*, 9>&, LeafQuality);
+
 unsigned char ChunkMeshingData::getBlock(int x, int y, int z) const {
     if (y < 0 || y >= CHUNK_HEIGHT) return 0;
     return m_Blocks[x + 1][y][z + 1];
@@ -227,6 +223,11 @@ void SimpleMesher::generateMesh(const ChunkMeshingData& data, const glm::ivec3&
     LeafQuality quality = data.getLeafQuality();
 
     for (int y = 0; y < CHUNK_HEIGHT; y++) {
+        // An all-air section has no faces of its own; its neighbours draw the faces bordering it.
+        if (y % SECTION_HEIGHT == 0 && data.isSectionEmpty(y / SECTION_HEIGHT)) {
+            y += SECTION_HEIGHT - 1;
+            continue;
+        }
         for (int x = 0; x < CHUNK_WIDTH; x++) {
             for (int z = 0; z < CHUNK_DEPTH; z++) {
                 BlockID currentBlock = (BlockID)data.getBlock(x, y, z);
@@ -6,7 +6,6 @@
 #include <glm/glm.hpp>
 #include <memory>
 
-class Chunk;
 class World;
 
 const int PADDED_WIDTH = CHUNK_WIDTH + 2;
@@ -15,16 +14,22 @@ const int PADDED_DEPTH = CHUNK_DEPTH + 2;
 
 class ChunkMeshingData {
 public:
-    ChunkMeshingData(World& world, const glm::ivec3& centralChunkPos);
+    // Copies the centre chunk and the facing borders of its neighbours, given in [z][x]
+    // order around the centre (index 4), with nullptr for chunks that aren't loaded.
+    // ChunkT is a chunk snapshot in the game; benchmarks pass chunks directly.
+    template<typename ChunkT>
+    ChunkMeshingData(const std::array<const ChunkT*, 9>& neighbors, LeafQuality leafQuality);
 
     unsigned char getBlock(int x, int y, int z) const;
     unsigned char getSunlight(int x, int y, int z) const;
     unsigned char getBlockLight(int x, int y, int z) const;
     LeafQuality getLeafQuality() const { return m_LeafQuality; };
+    bool isSectionEmpty(int sectionY) const { return m_SectionEmpty[sectionY]; }
 
 private:
     unsigned char m_Blocks[PADDED_WIDTH][PADDED_HEIGHT][PADDED_DEPTH] = { 0 };
     unsigned char m_LightLevels[PADDED_WIDTH][PADDED_HEIGHT][PADDED_DEPTH] = { 0 };
+    bool m_SectionEmpty[SECTION_COUNT];
     LeafQuality m_LeafQuality;
 };
 
@@ -0,0 +1,67 @@
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// See NoiseBatchSse41.cpp. FMA is deliberately left disabled so GCC can't contract the
+// multiplies and adds and drift from FastNoiseLite's rounding.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#include "NoiseKernel.h"
+
+namespace {
+    struct Avx2 {
+        using F = __m256;
+        using I = __m256i;
+        static const int WIDTH = 8;
+
+        static F load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+        static F set1(float v) { return _mm256_set1_ps(v); }
+        static I set1i(int v) { return _mm256_set1_epi32(v); }
+
+        static F add(F a, F b) { return _mm256_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+        static F min(F a, F b) { return _mm256_min_ps(a, b); }
+        static F abs(F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+        static F greater(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static F less(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static F mask(F v, F m) { return _mm256_and_ps(v, m); }
+        static F select(F m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+        static I selecti(F m, I a, I b) { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m)); }
+        static I maskToInt(F m) { return _mm256_castps_si256(m); }
+
+        static I truncate(F v) { return _mm256_cvttps_epi32(v); }
+        static F toFloat(I v) { return _mm256_cvtepi32_ps(v); }
+        static I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+        static I muli(I a, I b) { return _mm256_mullo_epi32(a, b); }
+        static I xori(I a, I b) { return _mm256_xor_si256(a, b); }
+        static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+        static I ori(I a, I b) { return _mm256_or_si256(a, b); }
+        template<int Bits>
+        static I shiftRight(I v) { return _mm256_srai_epi32(v, Bits); }
+
+        static F gather(const float* table, I index) { return _mm256_i32gather_ps(table, index, 4); }
+    };
+}
+
+void noiseAvx2(const NoiseKernelParams& params, const float* x, const float* y, float* out, int count) {
+    NoiseKernel<Avx2>::noise(params, x, y, out, count);
+}
+
+void domainWarpAvx2(const NoiseKernelParams& params, float* x, float* y, int count) {
+    NoiseKernel<Avx2>::domainWarp(params, x, y, count);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
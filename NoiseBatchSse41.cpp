@@ -0,0 +1,71 @@
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// MSVC emits these intrinsics without extra flags; GCC and Clang need the target enabled
+// for this file only, since the dispatcher only calls in after checking the CPU.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+#include "NoiseKernel.h"
+
+namespace {
+    struct Sse41 {
+        using F = __m128;
+        using I = __m128i;
+        static const int WIDTH = 4;
+
+        static F load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+        static F set1(float v) { return _mm_set1_ps(v); }
+        static I set1i(int v) { return _mm_set1_epi32(v); }
+
+        static F add(F a, F b) { return _mm_add_ps(a, b); }
+        static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+        static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+        static F min(F a, F b) { return _mm_min_ps(a, b); }
+        static F abs(F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+        static F greater(F a, F b) { return _mm_cmpgt_ps(a, b); }
+        static F less(F a, F b) { return _mm_cmplt_ps(a, b); }
+        static F mask(F v, F m) { return _mm_and_ps(v, m); }
+        static F select(F m, F a, F b) { return _mm_blendv_ps(b, a, m); }
+        static I selecti(F m, I a, I b) { return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(b), _mm_castsi128_ps(a), m)); }
+        static I maskToInt(F m) { return _mm_castps_si128(m); }
+
+        static I truncate(F v) { return _mm_cvttps_epi32(v); }
+        static F toFloat(I v) { return _mm_cvtepi32_ps(v); }
+        static I addi(I a, I b) { return _mm_add_epi32(a, b); }
+        static I muli(I a, I b) { return _mm_mullo_epi32(a, b); }
+        static I xori(I a, I b) { return _mm_xor_si128(a, b); }
+        static I andi(I a, I b) { return _mm_and_si128(a, b); }
+        static I ori(I a, I b) { return _mm_or_si128(a, b); }
+        template<int Bits>
+        static I shiftRight(I v) { return _mm_srai_epi32(v, Bits); }
+
+        // SSE has no gather; four scalar loads are still cheaper than leaving the vector unit.
+        static F gather(const float* table, I index) {
+            return _mm_setr_ps(table[_mm_extract_epi32(index, 0)], table[_mm_extract_epi32(index, 1)],
+                table[_mm_extract_epi32(index, 2)], table[_mm_extract_epi32(index, 3)]);
+        }
+    };
+}
+
+void noiseSse41(const NoiseKernelParams& params, const float* x, const float* y, float* out, int count) {
+    NoiseKernel<Sse41>::noise(params, x, y, out, count);
+}
+
+void domainWarpSse41(const NoiseKernelParams& params, float* x, float* y, int count) {
+    NoiseKernel<Sse41>::domainWarp(params, x, y, count);
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
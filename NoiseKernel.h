@@ -0,0 +1,261 @@
+#pragma once
+
+// Internal to NoiseBatch. The kernels are written once against a small vector interface V
+// and instantiated per instruction set in NoiseBatchSse41.cpp and NoiseBatchAvx2.cpp. Every
+// operation mirrors FastNoiseLite's scalar code in the same order, without fused
+// multiply-adds, so each lane rounds exactly like a GetNoise/DomainWarp call.
+
+enum class NoiseKernelFractal { None, FBm, Ridged };
+
+struct NoiseKernelParams {
+    int seed;
+    float frequency;
+    NoiseKernelFractal fractal;
+    int octaves;
+    float lacunarity;
+    float gain;
+    float weightedStrength;
+    float fractalBounding;
+    // Domain warp amplitude, already scaled like FastNoiseLite::DoSingleDomainWarp.
+    float warpAmp;
+    const float* gradients2D;
+    const float* randVecs2D;
+};
+
+void noiseSse41(const NoiseKernelParams& params, const float* x, const float* y, float* out, int count);
+void domainWarpSse41(const NoiseKernelParams& params, float* x, float* y, int count);
+void noiseAvx2(const NoiseKernelParams& params, const float* x, const float* y, float* out, int count);
+void domainWarpAvx2(const NoiseKernelParams& params, float* x, float* y, int count);
+
+template<typename V>
+struct NoiseKernel {
+    using F = typename V::F;
+    using I = typename V::I;
+
+    static const int PRIME_X = 501125321;
+    static const int PRIME_Y = 1136930381;
+
+    // Same expressions as FastNoiseLite, evaluated in float.
+    static float skewF2() {
+        const float SQRT3 = (float)1.7320508075688772935274463415059;
+        return 0.5f * (SQRT3 - 1);
+    }
+    static float simplexG2() {
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        return (3 - SQRT3) / 6;
+    }
+
+    static void noise(const NoiseKernelParams& p, const float* x, const float* y, float* out, int count) {
+        int i = 0;
+        for (; i + V::WIDTH <= count; i += V::WIDTH) {
+            V::store(out + i, noiseBlock(p, V::load(x + i), V::load(y + i)));
+        }
+        if (i < count) {
+            float tailX[V::WIDTH] = {};
+            float tailY[V::WIDTH] = {};
+            float tailOut[V::WIDTH];
+            for (int t = 0; t < count - i; ++t) {
+                tailX[t] = x[i + t];
+                tailY[t] = y[i + t];
+            }
+            V::store(tailOut, noiseBlock(p, V::load(tailX), V::load(tailY)));
+            for (int t = 0; t < count - i; ++t) {
+                out[i + t] = tailOut[t];
+            }
+        }
+    }
+
+    static void domainWarp(const NoiseKernelParams& p, float* x, float* y, int count) {
+        int i = 0;
+        for (; i + V::WIDTH <= count; i += V::WIDTH) {
+            F xv = V::load(x + i);
+            F yv = V::load(y + i);
+            warpBlock(p, xv, yv);
+            V::store(x + i, xv);
+            V::store(y + i, yv);
+        }
+        if (i < count) {
+            float tailX[V::WIDTH] = {};
+            float tailY[V::WIDTH] = {};
+            for (int t = 0; t < count - i; ++t) {
+                tailX[t] = x[i + t];
+                tailY[t] = y[i + t];
+            }
+            F xv = V::load(tailX);
+            F yv = V::load(tailY);
+            warpBlock(p, xv, yv);
+            V::store(tailX, xv);
+            V::store(tailY, yv);
+            for (int t = 0; t < count - i; ++t) {
+                x[i + t] = tailX[t];
+                y[i + t] = tailY[t];
+            }
+        }
+    }
+
+private:
+    // FastNoiseLite::GetNoise: frequency, OpenSimplex2 skew, then the fractal.
+    static F noiseBlock(const NoiseKernelParams& p, F x, F y) {
+        x = V::mul(x, V::set1(p.frequency));
+        y = V::mul(y, V::set1(p.frequency));
+        F t = V::mul(V::add(x, y), V::set1(skewF2()));
+        x = V::add(x, t);
+        y = V::add(y, t);
+
+        if (p.fractal == NoiseKernelFractal::None) {
+            return simplex(p, V::set1i(p.seed), x, y);
+        }
+
+        const F one = V::set1(1.0f);
+        int seed = p.seed;
+        F sum = V::set1(0.0f);
+        F amp = V::set1(p.fractalBounding);
+        for (int octave = 0; octave < p.octaves; ++octave) {
+            F n = simplex(p, V::set1i(seed++), x, y);
+            F weight;
+            if (p.fractal == NoiseKernelFractal::FBm) {
+                sum = V::add(sum, V::mul(n, amp));
+                weight = V::mul(V::min(V::add(n, one), V::set1(2.0f)), V::set1(0.5f));
+            }
+            else {
+                n = V::abs(n);
+                sum = V::add(sum, V::mul(V::add(V::mul(n, V::set1(-2.0f)), one), amp));
+                weight = V::sub(one, n);
+            }
+            // Lerp(1, weight, weightedStrength)
+            amp = V::mul(amp, V::add(one, V::mul(V::set1(p.weightedStrength), V::sub(weight, one))));
+
+            x = V::mul(x, V::set1(p.lacunarity));
+            y = V::mul(y, V::set1(p.lacunarity));
+            amp = V::mul(amp, V::set1(p.gain));
+        }
+        return sum;
+    }
+
+    static I fastFloor(F f) {
+        // (int)f, minus one for negative f; the all-ones compare mask is -1.
+        return V::addi(V::truncate(f), V::maskToInt(V::less(f, V::set1(0.0f))));
+    }
+
+    static I hash(I seed, I xPrimed, I yPrimed) {
+        return V::muli(V::xori(V::xori(seed, xPrimed), yPrimed), V::set1i(0x27d4eb2d));
+    }
+
+    static F gradCoord(const NoiseKernelParams& p, I seed, I xPrimed, I yPrimed, F xd, F yd) {
+        I h = hash(seed, xPrimed, yPrimed);
+        h = V::xori(h, V::template shiftRight<15>(h));
+        h = V::andi(h, V::set1i(127 << 1));
+        F xg = V::gather(p.gradients2D, h);
+        F yg = V::gather(p.gradients2D, V::ori(h, V::set1i(1)));
+        return V::add(V::mul(xd, xg), V::mul(yd, yg));
+    }
+
+    static void gradCoordDual(const NoiseKernelParams& p, I seed, I xPrimed, I yPrimed, F xd, F yd, F& xo, F& yo) {
+        I h = hash(seed, xPrimed, yPrimed);
+        I index1 = V::andi(h, V::set1i(127 << 1));
+        I index2 = V::andi(V::template shiftRight<7>(h), V::set1i(255 << 1));
+        F xg = V::gather(p.gradients2D, index1);
+        F yg = V::gather(p.gradients2D, V::ori(index1, V::set1i(1)));
+        F value = V::add(V::mul(xd, xg), V::mul(yd, yg));
+        xo = V::mul(value, V::gather(p.randVecs2D, index2));
+        yo = V::mul(value, V::gather(p.randVecs2D, V::ori(index2, V::set1i(1))));
+    }
+
+    // Lattice setup shared by SingleSimplex and SingleDomainWarpSimplexGradient.
+    struct Simplex {
+        I i, j;
+        I i1, j1;
+        F t;
+        F x0, y0, x1, y1, x2, y2;
+        F a, b, c;
+    };
+
+    static Simplex setupSimplex(F x, F y) {
+        const float G2 = simplexG2();
+        Simplex s;
+        I i = fastFloor(x);
+        I j = fastFloor(y);
+        F xi = V::sub(x, V::toFloat(i));
+        F yi = V::sub(y, V::toFloat(j));
+
+        s.t = V::mul(V::add(xi, yi), V::set1(G2));
+        s.x0 = V::sub(xi, s.t);
+        s.y0 = V::sub(yi, s.t);
+        s.i = V::muli(i, V::set1i(PRIME_X));
+        s.j = V::muli(j, V::set1i(PRIME_Y));
+
+        const F half = V::set1(0.5f);
+        s.a = V::sub(V::sub(half, V::mul(s.x0, s.x0)), V::mul(s.y0, s.y0));
+
+        s.c = V::add(V::mul(V::set1((float)(2 * (1 - 2 * G2) * (1 / G2 - 2))), s.t),
+            V::add(V::set1((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2))), s.a));
+        s.x2 = V::add(s.x0, V::set1(2 * (float)G2 - 1));
+        s.y2 = V::add(s.y0, V::set1(2 * (float)G2 - 1));
+
+        // Upper triangle (y0 > x0) takes the (0, 1) corner, the lower one (1, 0).
+        F upper = V::greater(s.y0, s.x0);
+        s.x1 = V::add(s.x0, V::select(upper, V::set1((float)G2), V::set1((float)G2 - 1)));
+        s.y1 = V::add(s.y0, V::select(upper, V::set1((float)G2 - 1), V::set1((float)G2)));
+        s.i1 = V::selecti(upper, s.i, V::addi(s.i, V::set1i(PRIME_X)));
+        s.j1 = V::selecti(upper, V::addi(s.j, V::set1i(PRIME_Y)), s.j);
+        s.b = V::sub(V::sub(half, V::mul(s.x1, s.x1)), V::mul(s.y1, s.y1));
+        return s;
+    }
+
+    static F pow4(F v) {
+        return V::mul(V::mul(v, v), V::mul(v, v));
+    }
+
+    // FastNoiseLite::SingleSimplex. A corner with a non-positive falloff contributes +0,
+    // as the scalar branch does.
+    static F simplex(const NoiseKernelParams& p, I seed, F x, F y) {
+        Simplex s = setupSimplex(x, y);
+        const F zero = V::set1(0.0f);
+        I i2 = V::addi(s.i, V::set1i(PRIME_X));
+        I j2 = V::addi(s.j, V::set1i(PRIME_Y));
+
+        F n0 = V::mask(V::mul(pow4(s.a), gradCoord(p, seed, s.i, s.j, s.x0, s.y0)), V::greater(s.a, zero));
+        F n2 = V::mask(V::mul(pow4(s.c), gradCoord(p, seed, i2, j2, s.x2, s.y2)), V::greater(s.c, zero));
+        F n1 = V::mask(V::mul(pow4(s.b), gradCoord(p, seed, s.i1, s.j1, s.x1, s.y1)), V::greater(s.b, zero));
+
+        return V::mul(V::add(V::add(n0, n1), n2), V::set1(99.83685446303647f));
+    }
+
+    // FastNoiseLite::DomainWarpSingle with DomainWarpType_OpenSimplex2.
+    static void warpBlock(const NoiseKernelParams& p, F& x, F& y) {
+        F t = V::mul(V::add(x, y), V::set1(skewF2()));
+        F xs = V::mul(V::add(x, t), V::set1(p.frequency));
+        F ys = V::mul(V::add(y, t), V::set1(p.frequency));
+
+        Simplex s = setupSimplex(xs, ys);
+        const F zero = V::set1(0.0f);
+        I seed = V::set1i(p.seed);
+        I i2 = V::addi(s.i, V::set1i(PRIME_X));
+        I j2 = V::addi(s.j, V::set1i(PRIME_Y));
+
+        F vx = zero;
+        F vy = zero;
+        F xo, yo;
+
+        F inside = V::greater(s.a, zero);
+        F falloff = pow4(s.a);
+        gradCoordDual(p, seed, s.i, s.j, s.x0, s.y0, xo, yo);
+        vx = V::add(vx, V::mask(V::mul(falloff, xo), inside));
+        vy = V::add(vy, V::mask(V::mul(falloff, yo), inside));
+
+        inside = V::greater(s.c, zero);
+        falloff = pow4(s.c);
+        gradCoordDual(p, seed, i2, j2, s.x2, s.y2, xo, yo);
+        vx = V::add(vx, V::mask(V::mul(falloff, xo), inside));
+        vy = V::add(vy, V::mask(V::mul(falloff, yo), inside));
+
+        inside = V::greater(s.b, zero);
+        falloff = pow4(s.b);
+        gradCoordDual(p, seed, s.i1, s.j1, s.x1, s.y1, xo, yo);
+        vx = V::add(vx, V::mask(V::mul(falloff, xo), inside));
+        vy = V::add(vy, V::mask(V::mul(falloff, yo), inside));
+
+        x = V::add(x, V::mul(vx, V::set1(p.warpAmp)));
+        y = V::add(y, V::mul(vy, V::set1(p.warpAmp)));
+    }
+};
@@ -0,0 +1,197 @@
+#include "PalettedStorage.h"
+#include <cstring>
+
+namespace {
+    // Index widths are powers of two so an entry never straddles two words.
+    int bitsForPaletteSize(int paletteSize) {
+        if (paletteSize <= 1) return 0;
+        if (paletteSize <= 2) return 1;
+        if (paletteSize <= 4) return 2;
+        if (paletteSize <= 16) return 4;
+        return 8;
+    }
+
+    int shiftForBits(int bits) {
+        switch (bits) {
+        case 1: return 0;
+        case 2: return 1;
+        case 4: return 2;
+        default: return 3;
+        }
+    }
+
+    int wordCount(int size, int bits) {
+        int entriesPerWord = 64 / bits;
+        return (size + entriesPerWord - 1) / entriesPerWord;
+    }
+}
+
+PalettedStorage::PalettedStorage(int size, unsigned char initialValue) : m_Size(size) {
+    fill(initialValue);
+}
+
+void PalettedStorage::set(int index, unsigned char value) {
+    unsigned int oldIndex = (m_BitsPerEntry == 0) ? 0 : getPaletteIndex(index);
+    if (m_Palette[oldIndex] == value) return;
+
+    int newIndex = -1;
+    int freeSlot = -1;
+    for (int i = 0; i < (int)m_Palette.size(); ++i) {
+        if (m_RefCounts[i] == 0) {
+            if (freeSlot < 0) freeSlot = i;
+        }
+        else if (m_Palette[i] == value) {
+            newIndex = i;
+            break;
+        }
+    }
+
+    if (newIndex < 0) {
+        if (freeSlot >= 0) {
+            newIndex = freeSlot;
+            m_Palette[freeSlot] = value;
+        }
+        else {
+            if ((int)m_Palette.size() == (1 << m_BitsPerEntry)) {
+                repack(m_BitsPerEntry == 0 ? 1 : m_BitsPerEntry * 2);
+                oldIndex = getPaletteIndex(index);
+            }
+            newIndex = (int)m_Palette.size();
+            m_Palette.push_back(value);
+            m_RefCounts.push_back(0);
+        }
+        m_LiveEntries++;
+    }
+
+    m_RefCounts[newIndex]++;
+    setPaletteIndex(index, newIndex);
+
+    if (--m_RefCounts[oldIndex] == 0) {
+        m_LiveEntries--;
+        if (m_LiveEntries == 1) {
+            fill(value);
+            return;
+        }
+        // Only narrow once the live palette fills at most half of the smaller width,
+        // so a value that keeps appearing and disappearing doesn't repack on every write.
+        int targetBits = bitsForPaletteSize(m_LiveEntries);
+        if (targetBits < m_BitsPerEntry && m_LiveEntries * 2 <= (1 << targetBits)) {
+            repack(targetBits);
+        }
+    }
+}
+
+void PalettedStorage::fill(unsigned char value) {
+    clear(value);
+    m_Words.shrink_to_fit();
+}
+
+void PalettedStorage::clear(unsigned char value) {
+    m_BitsPerEntry = 0;
+    m_BitsShift = 0;
+    m_Mask = 0;
+    m_LiveEntries = 1;
+    m_Palette.assign(1, value);
+    m_RefCounts.assign(1, static_cast<uint16_t>(m_Size));
+    m_Words.clear();
+}
+
+void PalettedStorage::decode(unsigned char* out) const {
+    if (m_BitsPerEntry == 0) {
+        std::memset(out, m_Palette[0], m_Size);
+        return;
+    }
+
+    const int entriesPerWord = 64 / m_BitsPerEntry;
+    int i = 0;
+    for (uint64_t word : m_Words) {
+        int count = (m_Size - i < entriesPerWord) ? m_Size - i : entriesPerWord;
+        for (int e = 0; e < count; ++e) {
+            out[i++] = m_Palette[word & m_Mask];
+            word >>= m_BitsPerEntry;
+        }
+    }
+}
+
+void PalettedStorage::encode(const unsigned char* data) {
+    unsigned int counts[256] = { 0 };
+    for (int i = 0; i < m_Size; ++i) {
+        counts[data[i]]++;
+    }
+
+    unsigned char remap[256];
+    m_Palette.clear();
+    m_RefCounts.clear();
+    for (int v = 0; v < 256; ++v) {
+        if (counts[v] == 0) continue;
+        remap[v] = static_cast<unsigned char>(m_Palette.size());
+        m_Palette.push_back(static_cast<unsigned char>(v));
+        m_RefCounts.push_back(static_cast<uint16_t>(counts[v]));
+    }
+
+    if (m_Palette.size() == 1) {
+        fill(m_Palette[0]);
+        return;
+    }
+
+    m_LiveEntries = (int)m_Palette.size();
+    m_BitsPerEntry = bitsForPaletteSize(m_LiveEntries);
+    m_BitsShift = shiftForBits(m_BitsPerEntry);
+    m_Mask = (1ull << m_BitsPerEntry) - 1;
+    m_Words.assign(wordCount(m_Size, m_BitsPerEntry), 0);
+    for (int i = 0; i < m_Size; ++i) {
+        setPaletteIndex(i, remap[data[i]]);
+    }
+}
+
+bool PalettedStorage::contains(unsigned char value) const {
+    for (size_t i = 0; i < m_Palette.size(); ++i) {
+        if (m_RefCounts[i] > 0 && m_Palette[i] == value) return true;
+    }
+    return false;
+}
+
+size_t PalettedStorage::getMemoryUsage() const {
+    return sizeof(PalettedStorage) +
+        m_Palette.capacity() * sizeof(unsigned char) +
+        m_RefCounts.capacity() * sizeof(uint16_t) +
+        m_Words.capacity() * sizeof(uint64_t);
+}
+
+void PalettedStorage::setPaletteIndex(int index, unsigned int paletteIndex) {
+    const int entriesShift = 6 - m_BitsShift;
+    uint64_t& word = m_Words[index >> entriesShift];
+    int shift = (index & ((1 << entriesShift) - 1)) << m_BitsShift;
+    word = (word & ~(m_Mask << shift)) | (static_cast<uint64_t>(paletteIndex) << shift);
+}
+
+void PalettedStorage::repack(int newBitsPerEntry) {
+    // Drops unused palette slots while re-encoding every entry at the new width.
+    unsigned char remap[256];
+    std::vector<unsigned char> palette;
+    std::vector<uint16_t> refCounts;
+    for (size_t i = 0; i < m_Palette.size(); ++i) {
+        if (m_RefCounts[i] == 0) continue;
+        remap[i] = static_cast<unsigned char>(palette.size());
+        palette.push_back(m_Palette[i]);
+        refCounts.push_back(m_RefCounts[i]);
+    }
+
+    PalettedStorage packed(m_Size);
+    packed.m_BitsPerEntry = newBitsPerEntry;
+    packed.m_BitsShift = shiftForBits(newBitsPerEntry);
+    packed.m_Mask = (1ull << newBitsPerEntry) - 1;
+    packed.m_Words.assign(wordCount(m_Size, newBitsPerEntry), 0);
+    for (int i = 0; i < m_Size; ++i) {
+        unsigned int oldIndex = (m_BitsPerEntry == 0) ? 0 : getPaletteIndex(i);
+        packed.setPaletteIndex(i, remap[oldIndex]);
+    }
+
+    m_BitsPerEntry = packed.m_BitsPerEntry;
+    m_BitsShift = packed.m_BitsShift;
+    m_Mask = packed.m_Mask;
+    m_LiveEntries = (int)palette.size();
+    m_Palette = std::move(palette);
+    m_RefCounts = std::move(refCounts);
+    m_Words = std::move(packed.m_Words);
+}
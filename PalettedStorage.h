@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Stores a fixed number of block IDs as indices into a small palette of distinct values.
+// Indices are packed into 64-bit words at 0, 1, 2, 4 or 8 bits per entry; a palette with a
+// single value needs 0 bits and keeps no index array at all.
+class PalettedStorage {
+public:
+    explicit PalettedStorage(int size, unsigned char initialValue = 0);
+
+    unsigned char get(int index) const {
+        if (m_BitsPerEntry == 0) return m_Palette[0];
+        return m_Palette[getPaletteIndex(index)];
+    }
+
+    void set(int index, unsigned char value);
+    void fill(unsigned char value);
+    // Like fill, but keeps the index array's memory for the next encode to reuse.
+    void clear(unsigned char value);
+
+    // Bulk conversion to and from a dense array of getSize() bytes.
+    void decode(unsigned char* out) const;
+    void encode(const unsigned char* data);
+
+    int getSize() const { return m_Size; }
+    int getBitsPerEntry() const { return m_BitsPerEntry; }
+    int getPaletteSize() const { return m_LiveEntries; }
+    bool isUniform() const { return m_BitsPerEntry == 0; }
+    bool contains(unsigned char value) const;
+    size_t getMemoryUsage() const;
+
+private:
+    unsigned int getPaletteIndex(int index) const {
+        const int entriesShift = 6 - m_BitsShift;
+        uint64_t word = m_Words[index >> entriesShift];
+        int shift = (index & ((1 << entriesShift) - 1)) << m_BitsShift;
+        return static_cast<unsigned int>((word >> shift) & m_Mask);
+    }
+
+    void setPaletteIndex(int index, unsigned int paletteIndex);
+    void repack(int newBitsPerEntry);
+
+    int m_Size;
+    int m_BitsPerEntry = 0;
+    int m_BitsShift = 0;
+    uint64_t m_Mask = 0;
+    int m_LiveEntries = 1;
+    std::vector<unsigned char> m_Palette;
+    std::vector<uint16_t> m_RefCounts;
+    std::vector<uint64_t> m_Words;
+};
@@ -188,6 +188,7 @@ void Player::runPhysicsTick(World& world) {
 
 void Player::resolveCollisions(World& world) {
     float currentHeight = m_IsSneaking ? Physics::CROUCH_PLAYER_HEIGHT : Physics::PLAYER_HEIGHT;
+    WorldAccessor access = world.getAccessor();
     auto checkCollision = [&](const glm::vec3& pos) {
         glm::vec3 aabbMin = pos + glm::vec3(-Physics::PLAYER_WIDTH / 2.0f, 0.0f, -Physics::PLAYER_WIDTH / 2.0f);
         glm::vec3 aabbMax = pos + glm::vec3(Physics::PLAYER_WIDTH / 2.0f, currentHeight, Physics::PLAYER_WIDTH / 2.0f);
@@ -196,7 +197,7 @@ void Player::resolveCollisions(World& world) {
         for (int y = minBlock.y; y <= maxBlock.y; ++y) {
             for (int x = minBlock.x; x <= maxBlock.x; ++x) {
                 for (int z = minBlock.z; z <= maxBlock.z; ++z) {
-                    if (world.getBlock(x, y, z) != 0) return true;
+                    if (access.getBlock(x, y, z) != 0) return true;
                 }
             }
         }
@@ -256,7 +257,7 @@ void Player::resolveCollisions(World& world) {
         bool groundFound = false;
         for (int x = minBlock.x; x <= maxBlock.x; ++x) {
             for (int z = minBlock.z; z <= maxBlock.z; ++z) {
-                if (world.getBlock(x, minBlock.y, z) != 0) {
+                if (access.getBlock(x, minBlock.y, z) != 0) {
                     groundFound = true;
                     break;
                 }
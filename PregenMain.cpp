@@ -0,0 +1,10 @@
+#include "LightBenchmark.h"
+#include "WorldPregen.h"
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--light-benchmark") == 0) {
+        return runLightBenchmark();
+    }
+    return runWorldPregen(argc - 1, argv + 1);
+}
@@ -34,9 +34,10 @@ std::optional<RaycastResult> raycast(const glm::vec3& origin, const glm::vec3& d
 
     float distance = 0.0f;
     glm::ivec3 lastVoxel = currentVoxel;
+    WorldAccessor access = world.getAccessor();
 
     while (distance < maxDistance) {
-        if (world.getBlock(currentVoxel.x, currentVoxel.y, currentVoxel.z) != static_cast<unsigned char>(BlockID::Air)) {
+        if (access.getBlock(currentVoxel.x, currentVoxel.y, currentVoxel.z) != static_cast<unsigned char>(BlockID::Air)) {
             glm::ivec3 faceNormal(0);
             if (lastVoxel.x != currentVoxel.x) faceNormal.x = -step.x;
             else if (lastVoxel.y != currentVoxel.y) faceNormal.y = -step.y;
@@ -0,0 +1,194 @@
+#include "TerrainBenchmark.h"
+#include "Chunk.h"
+#include "NoiseBatch.h"
+#include "TerrainGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace {
+    const int BENCHMARK_SEED = 1337;
+    const int BENCHMARK_RADIUS = 6;
+    const int BENCHMARK_RUNS = 3;
+
+    struct TerrainTimings {
+        double noiseMs = 1e30;
+        double generateMs = 1e30;
+        unsigned long long checksum = 0;
+    };
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    struct LatticeResult {
+        double noiseMs = 1e30;
+        double generateMs = 1e30;
+        std::vector<int> heights;
+    };
+
+    // Times noise sampling and full generation of the benchmark area with a fresh generator
+    // per run, so the column cache starts empty, and records every column's surface height.
+    LatticeResult benchmarkLattice(const NoiseLatticeSpacing& lattice) {
+        const int diameter = 2 * BENCHMARK_RADIUS + 1;
+        const int chunkCount = diameter * diameter;
+
+        LatticeResult best;
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+            TerrainGenerator generator(BENCHMARK_SEED, lattice);
+            TerrainNoiseGrid grid;
+            auto start = std::chrono::steady_clock::now();
+            for (int x = -BENCHMARK_RADIUS; x <= BENCHMARK_RADIUS; ++x) {
+                for (int z = -BENCHMARK_RADIUS; z <= BENCHMARK_RADIUS; ++z) {
+                    generator.sampleNoiseGrid(x * CHUNK_WIDTH, z * CHUNK_DEPTH, CHUNK_WIDTH, CHUNK_DEPTH, grid);
+                }
+            }
+            double noiseMs = elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            for (int x = -BENCHMARK_RADIUS; x <= BENCHMARK_RADIUS; ++x) {
+                for (int z = -BENCHMARK_RADIUS; z <= BENCHMARK_RADIUS; ++z) {
+                    Chunk chunk(x, 0, z);
+                    generator.generateChunkData(chunk);
+                }
+            }
+            double generateMs = elapsedMs(start);
+
+            best.noiseMs = std::min(best.noiseMs, noiseMs / chunkCount);
+            best.generateMs = std::min(best.generateMs, generateMs / chunkCount);
+        }
+
+        TerrainGenerator generator(BENCHMARK_SEED, lattice);
+        std::vector<TerrainColumn> columns(CHUNK_WIDTH * CHUNK_DEPTH);
+        for (int x = -BENCHMARK_RADIUS; x <= BENCHMARK_RADIUS; ++x) {
+            for (int z = -BENCHMARK_RADIUS; z <= BENCHMARK_RADIUS; ++z) {
+                generator.getColumns(x * CHUNK_WIDTH, z * CHUNK_DEPTH, CHUNK_WIDTH, CHUNK_DEPTH, columns.data());
+                for (const TerrainColumn& column : columns) {
+                    best.heights.push_back(column.height);
+                }
+            }
+        }
+        return best;
+    }
+
+    void reportLattices(NoiseBatch::Kernel kernel) {
+        struct Preset {
+            const char* name;
+            NoiseLatticeSpacing lattice;
+        };
+        NoiseLatticeSpacing lowFrequency;
+        lowFrequency.continentalness = 8;
+        lowFrequency.biome = 8;
+        NoiseLatticeSpacing all4;
+        all4.continentalness = all4.biome = all4.warp = all4.terrain = all4.mountains = 4;
+        NoiseLatticeSpacing all8;
+        all8.continentalness = all8.biome = all8.warp = all8.terrain = all8.mountains = 8;
+        const Preset presets[] = {
+            { "full", NoiseLatticeSpacing::full() },
+            { "c8 b8", lowFrequency },
+            { "coarse", NoiseLatticeSpacing::coarse() },
+            { "all 4", all4 },
+            { "all 8", all8 },
+        };
+
+        NoiseBatch::setKernel(kernel);
+        printf("\nNoise lattice (continentalness, biome, warp, terrain, mountains), %s kernel\n", NoiseBatch::getKernelName(kernel));
+        printf("%-8s %-12s %14s %9s %14s %9s %8s %8s\n", "preset", "spacing", "noise ms/chunk", "speed-up",
+            "gen ms/chunk", "speed-up", "max dh", "mean dh");
+
+        LatticeResult reference;
+        for (const Preset& preset : presets) {
+            LatticeResult result = benchmarkLattice(preset.lattice);
+            if (&preset == &presets[0]) reference = result;
+
+            int maxDeviation = 0;
+            double totalDeviation = 0.0;
+            for (size_t i = 0; i < result.heights.size(); ++i) {
+                int deviation = std::abs(result.heights[i] - reference.heights[i]);
+                maxDeviation = std::max(maxDeviation, deviation);
+                totalDeviation += deviation;
+            }
+
+            const NoiseLatticeSpacing& l = preset.lattice;
+            char spacing[32];
+            snprintf(spacing, sizeof(spacing), "%d,%d,%d,%d,%d", l.continentalness, l.biome, l.warp, l.terrain, l.mountains);
+            printf("%-8s %-12s %14.3f %8.2fx %14.3f %8.2fx %8d %8.2f\n", preset.name, spacing,
+                result.noiseMs, reference.noiseMs / result.noiseMs,
+                result.generateMs, reference.generateMs / result.generateMs,
+                maxDeviation, totalDeviation / result.heights.size());
+        }
+    }
+
+    TerrainTimings benchmarkKernel(NoiseBatch::Kernel kernel) {
+        NoiseBatch::setKernel(kernel);
+        const int diameter = 2 * BENCHMARK_RADIUS + 1;
+        const int chunkCount = diameter * diameter;
+
+        TerrainTimings best;
+        for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+            TerrainGenerator generator(BENCHMARK_SEED);
+
+            TerrainNoiseGrid grid;
+            auto start = std::chrono::steady_clock::now();
+            for (int x = -BENCHMARK_RADIUS; x <= BENCHMARK_RADIUS; ++x) {
+                for (int z = -BENCHMARK_RADIUS; z <= BENCHMARK_RADIUS; ++z) {
+                    generator.sampleNoiseGrid(x * CHUNK_WIDTH, z * CHUNK_DEPTH, CHUNK_WIDTH, CHUNK_DEPTH, grid);
+                }
+            }
+            double noiseMs = elapsedMs(start);
+
+            std::vector<std::unique_ptr<Chunk>> chunks;
+            for (int x = -BENCHMARK_RADIUS; x <= BENCHMARK_RADIUS; ++x) {
+                for (int z = -BENCHMARK_RADIUS; z <= BENCHMARK_RADIUS; ++z) {
+                    chunks.push_back(std::make_unique<Chunk>(x, 0, z));
+                }
+            }
+            start = std::chrono::steady_clock::now();
+            for (const auto& chunk : chunks) {
+                generator.generateChunkData(*chunk);
+            }
+            double generateMs = elapsedMs(start);
+
+            unsigned long long checksum = 0;
+            for (const auto& chunk : chunks) {
+                for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                    for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+                        for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                            checksum = checksum * 31 + chunk->getBlock(x, y, z);
+                        }
+                    }
+                }
+            }
+
+            best.noiseMs = std::min(best.noiseMs, noiseMs / chunkCount);
+            best.generateMs = std::min(best.generateMs, generateMs / chunkCount);
+            best.checksum = checksum;
+        }
+        return best;
+    }
+}
+
+int runTerrainBenchmark() {
+    const int diameter = 2 * BENCHMARK_RADIUS + 1;
+    printf("Seed %d, %dx%d chunks, best of %d runs\n", BENCHMARK_SEED, diameter, diameter, BENCHMARK_RUNS);
+    printf("%-8s %14s %14s %14s   %s\n", "kernel", "noise ms/chunk", "gen ms/chunk", "chunks/sec", "checksum");
+
+    const NoiseBatch::Kernel kernels[] = { NoiseBatch::Kernel::Scalar, NoiseBatch::Kernel::Sse41, NoiseBatch::Kernel::Avx2 };
+    const NoiseBatch::Kernel previous = NoiseBatch::getKernel();
+    for (NoiseBatch::Kernel kernel : kernels) {
+        if (kernel > NoiseBatch::getBestKernel()) break;
+        TerrainTimings timings = benchmarkKernel(kernel);
+        printf("%-8s %14.3f %14.3f %14.1f   %016llx\n", NoiseBatch::getKernelName(kernel),
+            timings.noiseMs, timings.generateMs, 1000.0 / timings.generateMs, timings.checksum);
+    }
+
+    reportLattices(NoiseBatch::Kernel::Scalar);
+    if (NoiseBatch::getBestKernel() != NoiseBatch::Kernel::Scalar) {
+        reportLattices(NoiseBatch::getBestKernel());
+    }
+    NoiseBatch::setKernel(previous);
+    return 0;
+}
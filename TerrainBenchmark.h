@@ -0,0 +1,7 @@
+#pragma once
+
+// Generates the same seed-1337 area with each noise kernel the CPU supports (scalar is the
+// per-point FastNoiseLite path) and prints chunks per second, then compares noise lattice
+// spacings against full-resolution sampling for speed and surface height deviation.
+// Returns a process exit code.
+int runTerrainBenchmark();
@@ -1,229 +1,543 @@
 #pragma once
 #include "FastNoiseLite.h"
+#include "NoiseBatch.h"
+#include "ColumnCache.h"
 #include "Chunk.h"
 #include "Block.h"
+#include <cstdint>
 #include <cstdlib>
-#include <ctime>
 #include <algorithm> // For std::max/min
+#include <array>
 #include <cmath>     // For pow
+#include <limits>
+#include <vector>
+
+// Distance in blocks between the columns each noise layer is actually sampled at; columns in
+// between are bilinearly interpolated from the surrounding lattice points. 1 samples every
+// column; other spacings are rounded down to a power of two. The terrain and mountain layers
+// are interpolated after the domain warp.
+struct NoiseLatticeSpacing {
+    int continentalness = 1;
+    int biome = 1;
+    int warp = 1;
+    int terrain = 1;
+    int mountains = 1;
+
+    static NoiseLatticeSpacing full() { return NoiseLatticeSpacing(); }
+
+    // The low-frequency layers on an 8-block lattice and the detailed ones on a 4-block one.
+    static NoiseLatticeSpacing coarse() {
+        NoiseLatticeSpacing spacing;
+        spacing.continentalness = 8;
+        spacing.biome = 8;
+        spacing.warp = 4;
+        spacing.terrain = 4;
+        spacing.mountains = 4;
+        return spacing;
+    }
 
-class TerrainGenerator {
+    bool operator==(const NoiseLatticeSpacing& other) const {
+        return continentalness == other.continentalness && biome == other.biome && warp == other.warp &&
+            terrain == other.terrain && mountains == other.mountains;
+    }
+};
+
+// Noise for a width x depth block of columns, indexed [x * depth + z]. Layer values are
+// already mapped to 0..1; warpX/warpZ are the domain-warped sample coordinates.
+struct TerrainNoiseGrid {
+    int width = 0;
+    int depth = 0;
+    std::vector<float> continentalness;
+    std::vector<float> biome;
+    std::vector<float> warpX;
+    std::vector<float> warpZ;
+    std::vector<float> terrain;
+    std::vector<float> mountains;
+};
+
+// SplitMix64 stream keyed by a seed and a column, so anything drawn from it is the same
+// no matter which thread generates the chunk or in what order chunks load.
+class PositionRandom {
 public:
-    enum class Biome {
-        Ocean,
-        Plains,
-        Forest
-    };
+    PositionRandom(int seed, int worldX, int worldZ) {
+        m_State = (uint64_t)(uint32_t)seed << 32;
+        m_State ^= (uint64_t)(uint32_t)worldX * 0x9E3779B97F4A7C15ull;
+        m_State ^= (uint64_t)(uint32_t)worldZ * 0xC2B2AE3D27D4EB4Full;
+    }
+
+    uint32_t next() {
+        uint64_t z = (m_State += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (uint32_t)((z ^ (z >> 31)) >> 32);
+    }
+
+    // Uniform enough for feature odds; bound must be positive.
+    int nextInt(int bound) { return (int)(next() % (uint32_t)bound); }
+
+private:
+    uint64_t m_State;
+};
+
+// One chunk's state carried between the generation stages of TerrainGenerator.
+struct ChunkGeneration {
+    explicit ChunkGeneration(const glm::ivec3& position) : position(position) {}
+
+    glm::ivec3 position;
+    // Shaped columns of the chunk and a border around it, [x][z].
+    std::vector<TerrainColumn> columns;
+    ChunkColumns blocks;
+};
 
-    TerrainGenerator(int seed) : m_Seed(seed) {
-        srand(seed);
+class TerrainGenerator {
+public:
+    static const int BASE_HEIGHT = 64;
+    static const int WATER_LEVEL = BASE_HEIGHT;
 
+    explicit TerrainGenerator(int seed, const NoiseLatticeSpacing& lattice = NoiseLatticeSpacing())
+        : m_Seed(seed), m_Lattice(lattice), m_ColumnCache(COLUMN_CACHE_CAPACITY) {
         // --- Core Terrain Noise ---
-        m_ContinentalnessNoise.SetSeed(seed);
-        m_ContinentalnessNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        m_ContinentalnessNoise.SetFrequency(0.0008f);
-
-        m_TerrainNoise.SetSeed(seed + 1);
-        m_TerrainNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        m_TerrainNoise.SetFrequency(0.004f);
-        m_TerrainNoise.SetFractalType(FastNoiseLite::FractalType_FBm);
-        m_TerrainNoise.SetFractalOctaves(5);
-
-        m_MountainNoise.SetSeed(seed + 2);
-        m_MountainNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        m_MountainNoise.SetFrequency(0.003f);
-        m_MountainNoise.SetFractalType(FastNoiseLite::FractalType_Ridged);
-        m_MountainNoise.SetFractalOctaves(6);
-
-        m_WarpNoise.SetSeed(seed + 3);
-        m_WarpNoise.SetFrequency(0.005f);
-        m_WarpNoise.SetDomainWarpAmp(35.0f);
+        m_ContinentalnessNoise.seed = seed;
+        m_ContinentalnessNoise.noiseType = FastNoiseLite::NoiseType_OpenSimplex2;
+        m_ContinentalnessNoise.frequency = 0.0008f;
+
+        m_TerrainNoise.seed = seed + 1;
+        m_TerrainNoise.noiseType = FastNoiseLite::NoiseType_OpenSimplex2;
+        m_TerrainNoise.frequency = 0.004f;
+        m_TerrainNoise.fractalType = FastNoiseLite::FractalType_FBm;
+        m_TerrainNoise.octaves = 5;
+
+        m_MountainNoise.seed = seed + 2;
+        m_MountainNoise.noiseType = FastNoiseLite::NoiseType_OpenSimplex2;
+        m_MountainNoise.frequency = 0.003f;
+        m_MountainNoise.fractalType = FastNoiseLite::FractalType_Ridged;
+        m_MountainNoise.octaves = 6;
+
+        m_WarpNoise.seed = seed + 3;
+        m_WarpNoise.frequency = 0.005f;
+        m_WarpNoise.domainWarpAmp = 35.0f;
 
         // --- Biome Noise ---
-        m_BiomeNoise.SetSeed(seed + 4);
-        m_BiomeNoise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
-        m_BiomeNoise.SetFrequency(0.0015f);
+        m_BiomeNoise.seed = seed + 4;
+        m_BiomeNoise.noiseType = FastNoiseLite::NoiseType_OpenSimplex2;
+        m_BiomeNoise.frequency = 0.0015f;
     }
 
-    void generateChunkData(Chunk& chunk) {
-        const int baseHeight = 64;
-        const int waterLevel = baseHeight;
-        const int deepWaterLevel = baseHeight - 12;
+    // Evaluates every noise layer for the columns starting at (worldX, worldZ) in batches. With
+    // a full-resolution lattice the results match sampling each column on its own.
+    void sampleNoiseGrid(int worldX, int worldZ, int width, int depth, TerrainNoiseGrid& grid) const {
+        std::vector<float> xs(width * depth);
+        std::vector<float> zs(width * depth);
+        for (int x = 0; x < width; ++x) {
+            for (int z = 0; z < depth; ++z) {
+                xs[x * depth + z] = (float)(worldX + x);
+                zs[x * depth + z] = (float)(worldZ + z);
+            }
+        }
+        sampleNoise(xs, zs, grid);
+        grid.width = width;
+        grid.depth = depth;
+    }
 
-        auto lerp = [](float a, float b, float t) {
-            return a + t * (b - a);
-            };
+    // Shaped columns for a width x depth block starting at (worldX, worldZ), written to
+    // out[x * depth + z]. Cached columns skip the noise; the rest are sampled in one batch.
+    // Safe to call from any thread, e.g. spawn finding or a map view.
+    void getColumns(int worldX, int worldZ, int width, int depth, TerrainColumn* out) const {
+        std::vector<int> missing;
+        std::vector<float> xs;
+        std::vector<float> zs;
+        for (int x = 0; x < width; ++x) {
+            for (int z = 0; z < depth; ++z) {
+                int index = x * depth + z;
+                if (m_ColumnCache.get(worldX + x, worldZ + z, out[index])) continue;
+                missing.push_back(index);
+                xs.push_back((float)(worldX + x));
+                zs.push_back((float)(worldZ + z));
+            }
+        }
+        if (missing.empty()) return;
+
+        TerrainNoiseGrid noise;
+        sampleNoise(xs, zs, noise);
+        for (size_t i = 0; i < missing.size(); ++i) {
+            int index = missing[i];
+            out[index] = shapeColumn(noise, (int)i);
+            m_ColumnCache.put(worldX + index / depth, worldZ + index % depth, out[index]);
+        }
+    }
 
-        Biome biomeMap[CHUNK_WIDTH][CHUNK_DEPTH];
+    TerrainColumn getColumn(int worldX, int worldZ) const {
+        TerrainColumn column;
+        getColumns(worldX, worldZ, 1, 1, &column);
+        return column;
+    }
+
+    const NoiseLatticeSpacing& getLatticeSpacing() const { return m_Lattice; }
+    ColumnCache::Stats getColumnCacheStats() const { return m_ColumnCache.getStats(); }
+    size_t getColumnCacheMemoryUsage() const { return m_ColumnCache.getMemoryUsage(); }
+
+    // Generation runs in three stages, each needing only the previous stage's output for the
+    // same chunk: shapeTerrain samples the heightmap, fillSurface writes the terrain runs and
+    // decorate adds trees and bedrock. Columns of neighbouring chunks come from the generator
+    // itself, so no stage has to wait for another chunk.
+    void shapeTerrain(ChunkGeneration& generation) const {
+        // A border of TREE_REACH columns too, so trees rooted in the neighbouring chunks
+        // can be replayed into this one.
+        const int width = CHUNK_WIDTH + 2 * TREE_REACH;
+        const int depth = CHUNK_DEPTH + 2 * TREE_REACH;
+        generation.columns.resize(width * depth);
+        getColumns(generation.position.x * CHUNK_WIDTH - TREE_REACH, generation.position.z * CHUNK_DEPTH - TREE_REACH,
+            width, depth, generation.columns.data());
+    }
 
+    void fillSurface(ChunkGeneration& generation) const {
+        // Everything is written as vertical runs into a column-major buffer, which replaces
+        // the chunk's blocks in one pass at the end.
+        const int depth = CHUNK_DEPTH + 2 * TREE_REACH;
+        const int baseY = generation.position.y * CHUNK_HEIGHT;
         for (int x = 0; x < CHUNK_WIDTH; ++x) {
             for (int z = 0; z < CHUNK_DEPTH; ++z) {
-                float worldX = (float)(chunk.m_Position.x * CHUNK_WIDTH + x);
-                float worldZ = (float)(chunk.m_Position.z * CHUNK_DEPTH + z);
-
-                // --- BIOME AND TERRAIN VALUES ---
-                float continentalness = (m_ContinentalnessNoise.GetNoise(worldX, worldZ) + 1.0f) / 2.0f;
-                float biomeValue = (m_BiomeNoise.GetNoise(worldX, worldZ) + 1.0f) / 2.0f;
+                const TerrainColumn& column = generation.columns[(x + TREE_REACH) * depth + z + TREE_REACH];
+                fillColumn(generation.blocks, x, z, baseY, column.height);
+            }
+        }
+    }
 
-                float warpX = worldX;
-                float warpZ = worldZ;
-                m_WarpNoise.DomainWarp(warpX, warpZ);
+    void decorate(ChunkGeneration& generation) const {
+        const int baseX = generation.position.x * CHUNK_WIDTH;
+        const int baseZ = generation.position.z * CHUNK_DEPTH;
+        const int width = CHUNK_WIDTH + 2 * TREE_REACH;
+        const int depth = CHUNK_DEPTH + 2 * TREE_REACH;
+
+        // Trees. Every tree that reaches this chunk, wherever it is rooted, writes into the
+        // pending buffer; the buffer keeps only this chunk's blocks and applies them once all
+        // trees are in, so a canopy crossing a border comes out the same on both sides.
+        PendingFeatureWrites writes(generation.position.x, generation.position.z);
+        for (int x = 0; x < width; ++x) {
+            for (int z = 0; z < depth; ++z) {
+                const TerrainColumn& column = generation.columns[x * depth + z];
+                int worldX = baseX - TREE_REACH + x;
+                int worldZ = baseZ - TREE_REACH + z;
+                placeTree(writes, column, worldX, worldZ);
+            }
+        }
+        writes.apply(generation.blocks);
 
-                float baseTerrain = (m_TerrainNoise.GetNoise(warpX, warpZ) + 1.0f) / 2.0f;
-                float mountains = (m_MountainNoise.GetNoise(warpX, warpZ) + 1.0f) / 2.0f;
+        // Bedrock
+        if (generation.position.y == 0) {
+            for (int x = 0; x < CHUNK_WIDTH; ++x) {
+                for (int z = 0; z < CHUNK_DEPTH; ++z) {
+                    generation.blocks.set(x, 0, z, (unsigned char)BlockID::Bedrock);
+                }
+            }
+        }
+    }
 
-                // --- HEIGHT CALCULATIONS FOR EACH BIOME TYPE ---
-                float plainsHeightNoise = pow(baseTerrain, 1.5f) * 0.9f;
-                float forestMountainBlend = std::max(baseTerrain, mountains * 1.2f);
-                float forestHeightNoise = lerp(pow(baseTerrain, 1.5f), forestMountainBlend, std::max(0.0f, mountains - 0.1f) * 1.2f);
+    // All three stages at once.
+    template<typename ChunkT>
+    void generateChunkData(ChunkT& chunk) const {
+        ChunkGeneration generation(chunk.m_Position);
+        shapeTerrain(generation);
+        fillSurface(generation);
+        decorate(generation);
+        chunk.setColumns(generation.blocks);
+    }
 
-                // --- BIOME DETERMINATION AND BLENDING ---
-                float landHeightNoise;
-                Biome currentBiome;
-                const float continentThreshold = 0.45f;
+private:
+    static const int DEEP_WATER_LEVEL = BASE_HEIGHT - 12;
+    // Horizontal distance a tree's leaves reach from its trunk.
+    static const int TREE_REACH = 2;
+    // Enough for every column within the default render distance, about 16 MB when full.
+    static const size_t COLUMN_CACHE_CAPACITY = 1 << 18;
+
+    // Blocks decorations write, collected for one chunk. Leaves only fill air and logs
+    // overwrite leaves, so the result doesn't depend on the order trees are added.
+    class PendingFeatureWrites {
+    public:
+        PendingFeatureWrites(int chunkX, int chunkZ)
+            : m_BaseX(chunkX * CHUNK_WIDTH), m_BaseZ(chunkZ * CHUNK_DEPTH) {}
+
+        void add(int worldX, int y, int worldZ, BlockID block) {
+            int x = worldX - m_BaseX;
+            int z = worldZ - m_BaseZ;
+            if (x < 0 || x >= CHUNK_WIDTH || z < 0 || z >= CHUNK_DEPTH || y < 0 || y >= CHUNK_HEIGHT) return;
+            m_Writes.push_back({ x, y, z, block });
+        }
 
-                if (continentalness < continentThreshold) {
-                    currentBiome = Biome::Ocean;
-                    landHeightNoise = 0;
+        void apply(ChunkColumns& blocks) const {
+            for (const Write& write : m_Writes) {
+                if (write.block == BlockID::OakLeaves && blocks.get(write.x, write.y, write.z) == (unsigned char)BlockID::Air) {
+                    blocks.set(write.x, write.y, write.z, (unsigned char)BlockID::OakLeaves);
                 }
-                else {
-                    const float plainsThreshold = 0.4f;
-                    const float forestThreshold = 0.6f;
-
-                    if (biomeValue < plainsThreshold) {
-                        currentBiome = Biome::Plains;
-                        landHeightNoise = plainsHeightNoise;
-                    }
-                    else if (biomeValue > forestThreshold) {
-                        currentBiome = Biome::Forest;
-                        landHeightNoise = forestHeightNoise;
-                    }
-                    else {
-                        currentBiome = biomeValue < 0.5f ? Biome::Plains : Biome::Forest;
-                        float blendFactor = (biomeValue - plainsThreshold) / (forestThreshold - plainsThreshold);
-                        landHeightNoise = lerp(plainsHeightNoise, forestHeightNoise, blendFactor);
-                    }
+            }
+            for (const Write& write : m_Writes) {
+                if (write.block != BlockID::OakLeaves) {
+                    blocks.set(write.x, write.y, write.z, (unsigned char)write.block);
                 }
-                biomeMap[x][z] = currentBiome;
+            }
+        }
 
-                // --- FINAL HEIGHT ASSEMBLY ---
-                int landHeight = waterLevel + static_cast<int>(landHeightNoise * (CHUNK_HEIGHT - waterLevel - 5));
-                int seaFloorHeight = deepWaterLevel + static_cast<int>(baseTerrain * (waterLevel - deepWaterLevel));
+    private:
+        struct Write {
+            int x, y, z;
+            BlockID block;
+        };
 
-                int terrainHeight;
-                if (currentBiome == Biome::Ocean) {
-                    terrainHeight = seaFloorHeight;
-                }
-                else {
-                    float blendFactor = std::min(1.0f, (continentalness - continentThreshold) / 0.1f);
-                    terrainHeight = static_cast<int>(lerp((float)seaFloorHeight, (float)landHeight, blendFactor));
-                }
+        int m_BaseX;
+        int m_BaseZ;
+        std::vector<Write> m_Writes;
+    };
 
-                terrainHeight = std::max(1, std::min(CHUNK_HEIGHT - 1, terrainHeight));
-
-                for (int y = 0; y < CHUNK_HEIGHT; ++y) {
-                    int worldY = chunk.m_Position.y * CHUNK_HEIGHT + y;
-                    if (worldY > terrainHeight) {
-                        if (worldY <= waterLevel) {
-                            chunk.setBlock(x, y, z, (unsigned char)BlockID::Stone); // Water
-                        }
-                        else {
-                            chunk.setBlock(x, y, z, (unsigned char)BlockID::Air);
-                        }
-                    }
-                    else if (worldY == terrainHeight) {
-                        if (worldY < waterLevel + 2 && worldY >= waterLevel) {
-                            chunk.setBlock(x, y, z, (unsigned char)BlockID::Dirt); // Beach
-                        }
-                        else {
-                            chunk.setBlock(x, y, z, (unsigned char)BlockID::Grass);
-                        }
-                    }
-                    else { // Below surface
-                        if (worldY > terrainHeight - 4) {
-                            chunk.setBlock(x, y, z, (unsigned char)BlockID::Dirt);
-                        }
-                        else {
-                            chunk.setBlock(x, y, z, (unsigned char)BlockID::Stone);
-                        }
-                    }
-                }
+    void sampleNoise(const std::vector<float>& xs, const std::vector<float>& zs, TerrainNoiseGrid& grid) const {
+        const int count = (int)xs.size();
+        grid.width = count;
+        grid.depth = 1;
+
+        auto plainLayer = [](const NoiseBatchConfig& noise) {
+            return [&noise](const std::vector<float>& px, const std::vector<float>& pz, std::array<std::vector<float>*, 1>& out) {
+                NoiseBatch::getNoise(noise, px.data(), pz.data(), out[0]->data(), (int)px.size());
+                };
+            };
+        sampleOnLattice<1>(m_Lattice.continentalness, xs, zs, { &grid.continentalness }, plainLayer(m_ContinentalnessNoise));
+        sampleOnLattice<1>(m_Lattice.biome, xs, zs, { &grid.biome }, plainLayer(m_BiomeNoise));
+
+        sampleWarp(xs, zs, grid.warpX, grid.warpZ);
+
+        auto warpedLayer = [&](const NoiseBatchConfig& noise, int spacing, std::vector<float>& out) {
+            if (spacing <= 1) {
+                out.resize(count);
+                NoiseBatch::getNoise(noise, grid.warpX.data(), grid.warpZ.data(), out.data(), count);
+                return;
             }
+            sampleOnLattice<1>(spacing, xs, zs, { &out },
+                [&](const std::vector<float>& px, const std::vector<float>& pz, std::array<std::vector<float>*, 1>& latticeOut) {
+                    std::vector<float> wx;
+                    std::vector<float> wz;
+                    sampleWarp(px, pz, wx, wz);
+                    NoiseBatch::getNoise(noise, wx.data(), wz.data(), latticeOut[0]->data(), (int)px.size());
+                });
+            };
+        warpedLayer(m_TerrainNoise, m_Lattice.terrain, grid.terrain);
+        warpedLayer(m_MountainNoise, m_Lattice.mountains, grid.mountains);
+
+        for (int i = 0; i < count; ++i) {
+            grid.continentalness[i] = (grid.continentalness[i] + 1.0f) / 2.0f;
+            grid.biome[i] = (grid.biome[i] + 1.0f) / 2.0f;
+            grid.terrain[i] = (grid.terrain[i] + 1.0f) / 2.0f;
+            grid.mountains[i] = (grid.mountains[i] + 1.0f) / 2.0f;
         }
+    }
 
-        // --- POST-PROCESSING ---
-        // Trees
-        for (int x = 2; x < CHUNK_WIDTH - 2; ++x) {
-            for (int z = 2; z < CHUNK_DEPTH - 2; ++z) {
-                int y = CHUNK_HEIGHT - 1;
-                for (; y >= 0; --y) {
-                    if (chunk.getBlock(x, y, z) != (unsigned char)BlockID::Air) break;
-                }
-                if (y < 0) continue;
-
-                if ((BlockID)chunk.getBlock(x, y, z) == BlockID::Grass) {
-                    int worldX = chunk.m_Position.x * CHUNK_WIDTH + x;
-                    int worldZ = chunk.m_Position.z * CHUNK_DEPTH + z;
-                    unsigned int hash = (worldX * 18397) ^ (worldZ * 38183) ^ m_Seed;
-
-                    Biome currentBiome = biomeMap[x][z];
-                    bool placeTree = false;
-                    switch (currentBiome) {
-                    case Biome::Forest:
-                        if ((hash % 100) < 6) placeTree = true;
-                        break;
-                    case Biome::Plains:
-                        if ((hash % 500) < 1) placeTree = true;
-                        break;
-                    default:
-                        break;
-                    }
-
-                    if (placeTree) {
-                        generateTree(chunk, x, y + 1, z);
-                    }
+    // Domain-warped positions of the given columns.
+    void sampleWarp(const std::vector<float>& xs, const std::vector<float>& zs, std::vector<float>& warpX, std::vector<float>& warpZ) const {
+        const int count = (int)xs.size();
+        if (m_Lattice.warp <= 1) {
+            warpX = xs;
+            warpZ = zs;
+            NoiseBatch::domainWarp(m_WarpNoise, warpX.data(), warpZ.data(), count);
+            return;
+        }
+
+        // Interpolate the offsets rather than the warped positions.
+        sampleOnLattice<2>(m_Lattice.warp, xs, zs, { &warpX, &warpZ },
+            [this](const std::vector<float>& px, const std::vector<float>& pz, std::array<std::vector<float>*, 2>& out) {
+                std::vector<float>& offsetX = *out[0];
+                std::vector<float>& offsetZ = *out[1];
+                offsetX = px;
+                offsetZ = pz;
+                NoiseBatch::domainWarp(m_WarpNoise, offsetX.data(), offsetZ.data(), (int)px.size());
+                for (size_t i = 0; i < px.size(); ++i) {
+                    offsetX[i] -= px[i];
+                    offsetZ[i] -= pz[i];
                 }
+            });
+        for (int i = 0; i < count; ++i) {
+            warpX[i] += xs[i];
+            warpZ[i] += zs[i];
+        }
+    }
+
+    // Fills Channels outputs for the given columns with evaluate(xs, zs, out). With a spacing
+    // above 1, evaluate only sees the corners of the world-aligned lattice cells the columns
+    // fall in, so a column gets the same value whichever chunk it is sampled for.
+    template<int Channels, typename Evaluate>
+    void sampleOnLattice(int spacing, const std::vector<float>& xs, const std::vector<float>& zs,
+        std::array<std::vector<float>*, Channels> out, Evaluate evaluate) const {
+        const int count = (int)xs.size();
+        for (int channel = 0; channel < Channels; ++channel) {
+            out[channel]->resize(count);
+        }
+        if (spacing <= 1) {
+            evaluate(xs, zs, out);
+            return;
+        }
+
+        // Spacings are powers of two, so cells and offsets are a shift and a mask away.
+        int shift = 0;
+        while ((2 << shift) <= spacing) shift++;
+        spacing = 1 << shift;
+        const int mask = spacing - 1;
+        const float step = 1.0f / spacing;
+
+        // Every lattice point of the cells covering the columns' bounding box, x-major.
+        int minCellX = std::numeric_limits<int>::max();
+        int minCellZ = std::numeric_limits<int>::max();
+        int maxCellX = std::numeric_limits<int>::min();
+        int maxCellZ = std::numeric_limits<int>::min();
+        for (int i = 0; i < count; ++i) {
+            int cellX = (int)xs[i] >> shift;
+            int cellZ = (int)zs[i] >> shift;
+            minCellX = std::min(minCellX, cellX);
+            minCellZ = std::min(minCellZ, cellZ);
+            maxCellX = std::max(maxCellX, cellX);
+            maxCellZ = std::max(maxCellZ, cellZ);
+        }
+        const int latticeWidth = maxCellX - minCellX + 2;
+        const int latticeDepth = maxCellZ - minCellZ + 2;
+        std::vector<float> latticeX(latticeWidth * latticeDepth);
+        std::vector<float> latticeZ(latticeWidth * latticeDepth);
+        for (int x = 0; x < latticeWidth; ++x) {
+            for (int z = 0; z < latticeDepth; ++z) {
+                latticeX[x * latticeDepth + z] = (float)((minCellX + x) * spacing);
+                latticeZ[x * latticeDepth + z] = (float)((minCellZ + z) * spacing);
             }
         }
 
-        // Bedrock
-        if (chunk.m_Position.y == 0) {
-            for (int x = 0; x < CHUNK_WIDTH; ++x) {
-                for (int z = 0; z < CHUNK_DEPTH; ++z) {
-                    chunk.setBlock(x, 0, z, (unsigned char)BlockID::Bedrock);
-                }
+        std::array<std::vector<float>, Channels> latticeValues;
+        std::array<std::vector<float>*, Channels> latticeOut;
+        for (int channel = 0; channel < Channels; ++channel) {
+            latticeValues[channel].resize(latticeX.size());
+            latticeOut[channel] = &latticeValues[channel];
+        }
+        evaluate(latticeX, latticeZ, latticeOut);
+
+        for (int i = 0; i < count; ++i) {
+            int x = (int)xs[i];
+            int z = (int)zs[i];
+            float tx = (x & mask) * step;
+            float tz = (z & mask) * step;
+            int corner = ((x >> shift) - minCellX) * latticeDepth + ((z >> shift) - minCellZ);
+            for (int channel = 0; channel < Channels; ++channel) {
+                const float* v = latticeValues[channel].data() + corner;
+                float rowStart = v[0] + tx * (v[latticeDepth] - v[0]);
+                float rowEnd = v[1] + tx * (v[latticeDepth + 1] - v[1]);
+                (*out[channel])[i] = rowStart + tz * (rowEnd - rowStart);
             }
         }
     }
 
-private:
-    void generateTree(Chunk& chunk, int x, int y, int z) {
-        int height = 4 + (rand() % 3);
-        if (y + height + 2 >= CHUNK_HEIGHT) return;
+    TerrainColumn shapeColumn(const TerrainNoiseGrid& noise, int index) const {
+        auto lerp = [](float a, float b, float t) {
+            return a + t * (b - a);
+            };
+
+        // --- BIOME AND TERRAIN VALUES ---
+        float continentalness = noise.continentalness[index];
+        float biomeValue = noise.biome[index];
+        float baseTerrain = noise.terrain[index];
+        float mountains = noise.mountains[index];
+
+        // --- HEIGHT CALCULATIONS FOR EACH BIOME TYPE ---
+        float plainsHeightNoise = pow(baseTerrain, 1.5f) * 0.9f;
+        float forestMountainBlend = std::max(baseTerrain, mountains * 1.2f);
+        float forestHeightNoise = lerp(pow(baseTerrain, 1.5f), forestMountainBlend, std::max(0.0f, mountains - 0.1f) * 1.2f);
+
+        // --- BIOME DETERMINATION AND BLENDING ---
+        float landHeightNoise;
+        Biome currentBiome;
+        const float continentThreshold = 0.45f;
+
+        if (continentalness < continentThreshold) {
+            currentBiome = Biome::Ocean;
+            landHeightNoise = 0;
+        }
+        else {
+            const float plainsThreshold = 0.4f;
+            const float forestThreshold = 0.6f;
+
+            if (biomeValue < plainsThreshold) {
+                currentBiome = Biome::Plains;
+                landHeightNoise = plainsHeightNoise;
+            }
+            else if (biomeValue > forestThreshold) {
+                currentBiome = Biome::Forest;
+                landHeightNoise = forestHeightNoise;
+            }
+            else {
+                currentBiome = biomeValue < 0.5f ? Biome::Plains : Biome::Forest;
+                float blendFactor = (biomeValue - plainsThreshold) / (forestThreshold - plainsThreshold);
+                landHeightNoise = lerp(plainsHeightNoise, forestHeightNoise, blendFactor);
+            }
+        }
+
+        // --- FINAL HEIGHT ASSEMBLY ---
+        int landHeight = WATER_LEVEL + static_cast<int>(landHeightNoise * (CHUNK_HEIGHT - WATER_LEVEL - 5));
+        int seaFloorHeight = DEEP_WATER_LEVEL + static_cast<int>(baseTerrain * (WATER_LEVEL - DEEP_WATER_LEVEL));
 
-        for (int i = 1; i < height + 2; ++i) {
-            if (chunk.getBlock(x, y + i, z) != 0) return;
+        int terrainHeight;
+        if (currentBiome == Biome::Ocean) {
+            terrainHeight = seaFloorHeight;
         }
+        else {
+            float blendFactor = std::min(1.0f, (continentalness - continentThreshold) / 0.1f);
+            terrainHeight = static_cast<int>(lerp((float)seaFloorHeight, (float)landHeight, blendFactor));
+        }
+
+        terrainHeight = std::max(1, std::min(CHUNK_HEIGHT - 1, terrainHeight));
+        return { terrainHeight, currentBiome };
+    }
+
+    // Stone, three dirt, then grass (dirt on beaches), with stone standing in for water up to
+    // WATER_LEVEL. The buffer starts out as air, which covers the rest. Heights are world Y;
+    // baseY is the world Y of the buffer's bottom.
+    void fillColumn(ChunkColumns& blocks, int x, int z, int baseY, int terrainHeight) const {
+        const bool beach = terrainHeight < WATER_LEVEL + 2 && terrainHeight >= WATER_LEVEL;
+        blocks.fill(x, z, 0, terrainHeight - 4 - baseY, (unsigned char)BlockID::Stone);
+        blocks.fill(x, z, terrainHeight - 3 - baseY, terrainHeight - 1 - baseY, (unsigned char)BlockID::Dirt);
+        blocks.fill(x, z, terrainHeight - baseY, terrainHeight - baseY, (unsigned char)(beach ? BlockID::Dirt : BlockID::Grass));
+        blocks.fill(x, z, terrainHeight + 1 - baseY, WATER_LEVEL - baseY, (unsigned char)BlockID::Stone); // Water
+    }
+
+    // Whether and how a tree grows depends only on the seed, the column's position and its
+    // shaped terrain, never on blocks other features have already written.
+    void placeTree(PendingFeatureWrites& writes, const TerrainColumn& column, int worldX, int worldZ) const {
+        // Only grass tops get trees; lower surfaces are beach or under water.
+        if (column.height < WATER_LEVEL + 2) return;
+
+        PositionRandom random(m_Seed, worldX, worldZ);
+        bool grows = false;
+        switch (column.biome) {
+        case Biome::Forest:
+            grows = random.nextInt(100) < 6;
+            break;
+        case Biome::Plains:
+            grows = random.nextInt(500) < 1;
+            break;
+        default:
+            break;
+        }
+        if (!grows) return;
+
+        int y = column.height + 1;
+        int height = 4 + random.nextInt(3);
+        if (y + height + 2 >= CHUNK_HEIGHT) return;
 
-        chunk.setBlock(x, y - 1, z, (unsigned char)BlockID::Dirt);
+        writes.add(worldX, y - 1, worldZ, BlockID::Dirt);
 
         for (int i = 0; i < height; ++i) {
-            chunk.setBlock(x, y + i, z, (unsigned char)BlockID::OakLog);
+            writes.add(worldX, y + i, worldZ, BlockID::OakLog);
         }
 
         auto placeLeaf = [&](int lx, int ly, int lz) {
-            if (lx < 0 || lx >= CHUNK_WIDTH || lz < 0 || lz >= CHUNK_DEPTH || ly < 0 || ly >= CHUNK_HEIGHT) return;
-            if (chunk.getBlock(lx, ly, lz) == (unsigned char)BlockID::Air) {
-                chunk.setBlock(lx, ly, lz, (unsigned char)BlockID::OakLeaves);
-            }
+            writes.add(lx, ly, lz, BlockID::OakLeaves);
             };
 
         for (int ly = y + height - 2; ly <= y + height - 1; ++ly) {
-            for (int dx = -2; dx <= 2; ++dx) {
-                for (int dz = -2; dz <= 2; ++dz) {
+            for (int dx = -TREE_REACH; dx <= TREE_REACH; ++dx) {
+                for (int dz = -TREE_REACH; dz <= TREE_REACH; ++dz) {
                     if (abs(dx) == 2 && abs(dz) == 2) continue;
                     if (dx == 0 && dz == 0) continue;
-                    placeLeaf(x + dx, ly, z + dz);
+                    placeLeaf(worldX + dx, ly, worldZ + dz);
                 }
             }
         }
@@ -231,22 +545,24 @@ private:
         int top_y = y + height;
         for (int dx = -1; dx <= 1; ++dx) {
             for (int dz = -1; dz <= 1; ++dz) {
-                placeLeaf(x + dx, top_y, z + dz);
+                placeLeaf(worldX + dx, top_y, worldZ + dz);
             }
         }
 
         int vtop_y = y + height + 1;
-        placeLeaf(x, vtop_y, z);
-        placeLeaf(x + 1, vtop_y, z);
-        placeLeaf(x - 1, vtop_y, z);
-        placeLeaf(x, vtop_y, z + 1);
-        placeLeaf(x, vtop_y, z - 1);
-    }
-
-    FastNoiseLite m_ContinentalnessNoise;
-    FastNoiseLite m_TerrainNoise;
-    FastNoiseLite m_MountainNoise;
-    FastNoiseLite m_WarpNoise;
-    FastNoiseLite m_BiomeNoise;
+        placeLeaf(worldX, vtop_y, worldZ);
+        placeLeaf(worldX + 1, vtop_y, worldZ);
+        placeLeaf(worldX - 1, vtop_y, worldZ);
+        placeLeaf(worldX, vtop_y, worldZ + 1);
+        placeLeaf(worldX, vtop_y, worldZ - 1);
+    }
+
+    NoiseBatchConfig m_ContinentalnessNoise;
+    NoiseBatchConfig m_TerrainNoise;
+    NoiseBatchConfig m_MountainNoise;
+    NoiseBatchConfig m_WarpNoise;
+    NoiseBatchConfig m_BiomeNoise;
     int m_Seed;
+    NoiseLatticeSpacing m_Lattice;
+    mutable ColumnCache m_ColumnCache;
 };
\ No newline at end of file
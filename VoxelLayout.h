@@ -0,0 +1,46 @@
+#pragma once
+
+// Orderings for the voxels of one 16x16x16 chunk section. Each maps section-local (x, y, z)
+// to an index into the section's block palette indices and light array, and is picked at
+// compile time as the template argument of BasicChunk.
+//
+// MATCHES_DENSE_ORDER is true when the ordering equals the dense [x][y][z] order Chunk
+// uses for bulk block transfers, so those can copy whole rows instead of single voxels.
+// MATCHES_COLUMN_ORDER is the same for ChunkColumns, where each (x, z) column is contiguous.
+
+// x, then y, then z: each x slice is one contiguous 16x16 (y, z) block.
+struct XYZLayout {
+    static constexpr bool MATCHES_DENSE_ORDER = true;
+    static constexpr bool MATCHES_COLUMN_ORDER = false;
+    static int getIndex(int x, int y, int z) { return (x * 16 + y) * 16 + z; }
+};
+
+// y-major: each horizontal layer is contiguous, matching SimpleMesher's y, x, z walk.
+struct YXZLayout {
+    static constexpr bool MATCHES_DENSE_ORDER = false;
+    static constexpr bool MATCHES_COLUMN_ORDER = false;
+    static int getIndex(int x, int y, int z) { return (y * 16 + x) * 16 + z; }
+};
+
+// Vertical columns are contiguous, matching the per-(x, z) column fill of terrain generation.
+struct XZYLayout {
+    static constexpr bool MATCHES_DENSE_ORDER = false;
+    static constexpr bool MATCHES_COLUMN_ORDER = true;
+    static int getIndex(int x, int y, int z) { return (x * 16 + z) * 16 + y; }
+};
+
+// Morton (Z-order) bricks: the bits of x, y and z are interleaved, so every aligned 2x2x2,
+// 4x4x4 and 8x8x8 brick is contiguous and all six neighbours tend to share cache lines.
+struct MortonLayout {
+    static constexpr bool MATCHES_DENSE_ORDER = false;
+    static constexpr bool MATCHES_COLUMN_ORDER = false;
+    static int getIndex(int x, int y, int z) { return (spread(x) << 2) | (spread(y) << 1) | spread(z); }
+
+private:
+    // Moves bit i of a 4-bit coordinate to bit 3 * i.
+    static int spread(int v) { return (v & 1) | ((v & 2) << 2) | ((v & 4) << 4) | ((v & 8) << 6); }
+};
+
+#ifndef VOXEL_LAYOUT
+#define VOXEL_LAYOUT XYZLayout
+#endif
@@ -6,10 +6,11 @@
 #include <cstring>
 #include <queue>
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 World::World() : m_LastPlayerChunkPos(9999, 0, 9999), m_IsRunning(true) {
-    m_TerrainGenerator = std::make_unique<TerrainGenerator>(1337);
+    m_TerrainGenerator = std::make_shared<TerrainGenerator>(1337);
     m_SimpleMesher = std::make_unique<SimpleMesher>();
     m_GreedyMesher = std::make_unique<GreedyMesher>();
 
@@ -17,8 +18,15 @@ World::World() : m_LastPlayerChunkPos(9999, 0, 9999), m_IsRunning(true) {
     for (unsigned int i = 0; i < num_threads; ++i) {
         m_MesherThreads.emplace_back(&World::mesherLoop, this);
     }
-    m_LightThread = std::thread(&World::lightingLoop, this);
-    std::cout << "Started " << num_threads << " mesher threads and 1 lighting thread." << std::endl;
+    unsigned int generatorThreads = std::max(1u, num_threads / 2);
+    for (unsigned int i = 0; i < generatorThreads; ++i) {
+        m_GeneratorThreads.emplace_back(&World::generatorLoop, this);
+    }
+    unsigned int lightThreads = std::max(1u, num_threads / 2);
+    for (unsigned int i = 0; i < lightThreads; ++i) {
+        m_LightThreads.emplace_back(&World::lightingLoop, this);
+    }
+    std::cout << "Started " << num_threads << " mesher threads, " << generatorThreads << " generator threads and " << lightThreads << " lighting threads." << std::endl;
 }
 
 World::~World() {
@@ -29,13 +37,21 @@ void World::stopThreads() {
     if (m_IsRunning) {
         m_IsRunning = false;
         m_MeshingQueue.stop();
-        m_LightUpdateQueue.stop();
-        m_InitialLightQueue.stop();
+        m_LightScheduler.stop();
+        {
+            std::lock_guard<std::mutex> lock(m_GenerationMutex);
+            m_GenerationCondition.notify_all();
+        }
 
         for (auto& thread : m_MesherThreads) {
             if (thread.joinable()) thread.join();
         }
-        if (m_LightThread.joinable()) m_LightThread.join();
+        for (auto& thread : m_GeneratorThreads) {
+            if (thread.joinable()) thread.join();
+        }
+        for (auto& thread : m_LightThreads) {
+            if (thread.joinable()) thread.join();
+        }
     }
 }
 
@@ -51,48 +67,226 @@ void World::update(const glm::vec3& playerPosition) {
         m_LastPlayerChunkPos = playerChunkPos;
     }
 
+    insertGeneratedChunks(playerChunkPos);
+    advancePipeline(playerChunkPos);
     buildDirtyChunks();
     processFinishedMeshes();
+    enforceMemoryBudget(playerChunkPos);
+    m_Reclaimer.collect();
 }
 
 void World::loadChunks(const glm::ivec3& playerChunkPos) {
     std::vector<glm::ivec3> toUnload;
-    {
-        std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-        for (auto const& [pos, chunk] : m_Chunks) {
-            if (abs(pos.x - playerChunkPos.x) > m_RenderDistance ||
-                abs(pos.z - playerChunkPos.z) > m_RenderDistance) {
-                toUnload.push_back(pos);
-            }
+    m_Chunks.forEach([&](const Chunk& chunk) {
+        const glm::ivec3& pos = chunk.m_Position;
+        if (!isWithinLoadDistance(pos, playerChunkPos)) {
+            toUnload.push_back(pos);
         }
-    }
+        });
 
-    {
-        std::unique_lock<std::shared_mutex> lock(m_ChunksMutex);
+    if (m_Chunks.getRadius() != m_RenderDistance) {
+        m_Chunks.reset(m_RenderDistance);
+    }
+    else {
         for (const auto& pos : toUnload) {
             m_Chunks.erase(pos);
         }
     }
-
+    m_Chunks.setCenter(playerChunkPos);
+    // Chunks on the new edge no longer wait for neighbours outside the load area.
+    checkPipelineEverywhere();
+
+    // Requests nobody has picked up yet are rebuilt around the new position; columns a
+    // generator is already working on stay pending and are checked again on arrival.
+    std::lock_guard<std::mutex> lock(m_GenerationMutex);
+    for (const auto& pos : m_GenerationRequests) {
+        m_PendingGeneration.erase(pos);
+    }
+    m_GenerationRequests.clear();
     for (int x = playerChunkPos.x - m_RenderDistance; x <= playerChunkPos.x + m_RenderDistance; ++x) {
         for (int z = playerChunkPos.z - m_RenderDistance; z <= playerChunkPos.z + m_RenderDistance; ++z) {
             glm::ivec3 pos(x, 0, z);
-            bool chunkExists;
-            {
-                std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-                chunkExists = m_Chunks.count(pos);
+            if (!m_Chunks.contains(pos) && isWithinLoadDistance(pos, playerChunkPos) && m_PendingGeneration.insert(pos).second) {
+                m_GenerationRequests.push_back(pos);
             }
+        }
+    }
+    auto distanceSq = [&](const glm::ivec3& pos) {
+        glm::ivec3 d = pos - playerChunkPos;
+        return d.x * d.x + d.z * d.z;
+        };
+    std::sort(m_GenerationRequests.begin(), m_GenerationRequests.end(), [&](const glm::ivec3& a, const glm::ivec3& b) {
+        return distanceSq(a) > distanceSq(b);
+        });
+    m_GenerationCondition.notify_all();
+}
 
-            if (!chunkExists) {
-                auto newChunk = std::make_shared<Chunk>(pos.x, pos.y, pos.z);
-                m_TerrainGenerator->generateChunkData(*newChunk);
-                {
-                    std::unique_lock<std::shared_mutex> lock(m_ChunksMutex);
-                    m_Chunks[pos] = std::move(newChunk);
-                }
-                m_InitialLightQueue.push(pos);
+void World::insertGeneratedChunks(const glm::ivec3& playerChunkPos) {
+    GeneratedChunk generated;
+    int inserted = 0;
+    while (inserted < m_ChunkInsertsPerFrame && m_GeneratedChunks.try_pop(generated)) {
+        glm::ivec3 pos = generated.chunk->m_Position;
+        m_PendingGeneration.erase(pos);
+        m_GenerationStatusCounts[static_cast<int>(ChunkStatus::Decorated)]--;
+        // The player may have moved away while it was generated, or the terrain settings changed.
+        // loadChunks skipped columns that were in flight when the settings changed, so one that
+        // is still wanted is requested again with the new generator.
+        if (generated.terrainRevision != m_TerrainRevision) {
+            if (!m_Chunks.contains(pos) && m_Chunks.isInRange(pos) && isWithinLoadDistance(pos, playerChunkPos)) {
+                std::lock_guard<std::mutex> lock(m_GenerationMutex);
+                m_PendingGeneration.insert(pos);
+                m_GenerationRequests.push_back(pos);
+                m_GenerationCondition.notify_one();
             }
+            continue;
         }
+        if (m_Chunks.contains(pos) || !m_Chunks.isInRange(pos) || !isWithinLoadDistance(pos, playerChunkPos)) continue;
+        m_Chunks.insert(std::move(generated.chunk));
+        checkPipeline(pos);
+        inserted++;
+    }
+}
+
+void World::advancePipeline(const glm::ivec3& playerChunkPos) {
+    glm::ivec3 litPos;
+    while (m_LitChunks.try_pop(litPos)) {
+        Chunk* chunk = m_Chunks.get(litPos.x, litPos.z);
+        if (!chunk || chunk->m_Status.load() != ChunkStatus::Lighting) continue;
+        chunk->m_Status = ChunkStatus::Lit;
+        checkPipeline(litPos);
+    }
+
+    for (const auto& pos : m_PipelineChecks) {
+        Chunk* chunk = m_Chunks.get(pos.x, pos.z);
+        if (!chunk) continue;
+        ChunkStatus status = chunk->m_Status.load();
+        // Initial light spills into the neighbours, so they need their blocks first.
+        if (status == ChunkStatus::Decorated && neighborsReached(pos, ChunkStatus::Decorated, playerChunkPos)) {
+            chunk->m_Status = ChunkStatus::Lighting;
+            m_LightScheduler.pushInitial(pos);
+        }
+        // The mesher samples light from the neighbours, which their own lighting may still change.
+        else if (status == ChunkStatus::Lit && neighborsReached(pos, ChunkStatus::Lit, playerChunkPos)) {
+            chunk->m_Status = ChunkStatus::Meshing;
+            std::lock_guard<std::mutex> lock(m_DirtyChunksMutex);
+            m_DirtyChunks.insert(pos);
+        }
+    }
+    m_PipelineChecks.clear();
+}
+
+bool World::neighborsReached(const glm::ivec3& chunkPos, ChunkStatus status, const glm::ivec3& playerChunkPos) const {
+    for (int z = -1; z <= 1; ++z) {
+        for (int x = -1; x <= 1; ++x) {
+            if (x == 0 && z == 0) continue;
+            glm::ivec3 pos = chunkPos + glm::ivec3(x, 0, z);
+            if (const Chunk* neighbor = m_Chunks.get(pos.x, pos.z)) {
+                if (neighbor->m_Status.load() < status) return false;
+            }
+            else if (m_Chunks.isInRange(pos) && isWithinLoadDistance(pos, playerChunkPos)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void World::checkPipeline(const glm::ivec3& chunkPos) {
+    for (int z = -1; z <= 1; ++z) {
+        for (int x = -1; x <= 1; ++x) {
+            m_PipelineChecks.insert(chunkPos + glm::ivec3(x, 0, z));
+        }
+    }
+}
+
+void World::checkPipelineEverywhere() {
+    m_Chunks.forEach([&](const Chunk& chunk) {
+        if (chunk.m_Status.load() < ChunkStatus::Meshing) {
+            m_PipelineChecks.insert(chunk.m_Position);
+        }
+        });
+}
+
+void World::setGenerationStatus(Chunk& chunk, ChunkStatus status) {
+    ChunkStatus previous = chunk.m_Status.exchange(status);
+    if (previous != ChunkStatus::Empty) {
+        m_GenerationStatusCounts[static_cast<int>(previous)]--;
+    }
+    m_GenerationStatusCounts[static_cast<int>(status)]++;
+}
+
+ChunkStageCounts World::getStageCounts() const {
+    ChunkStageCounts counts{};
+    m_Chunks.forEach([&](const Chunk& chunk) {
+        counts[static_cast<int>(chunk.m_Status.load())]++;
+        });
+    size_t generated = m_GenerationStatusCounts[static_cast<int>(ChunkStatus::Decorated)].load();
+    counts[static_cast<int>(ChunkStatus::Decorated)] += generated;
+    // Generator threads move on while we count, so the difference is only approximate.
+    counts[static_cast<int>(ChunkStatus::Empty)] = m_PendingGeneration.size() > generated ? m_PendingGeneration.size() - generated : 0;
+    return counts;
+}
+
+bool World::isWithinLoadDistance(const glm::ivec3& chunkPos, const glm::ivec3& playerChunkPos) const {
+    int dx = chunkPos.x - playerChunkPos.x;
+    int dz = chunkPos.z - playerChunkPos.z;
+    if (abs(dx) > m_RenderDistance || abs(dz) > m_RenderDistance) return false;
+    return dx * dx + dz * dz <= m_MaxLoadDistanceSq;
+}
+
+void World::enforceMemoryBudget(const glm::ivec3& playerChunkPos) {
+    if (m_MemoryBudget != m_AppliedMemoryBudget) {
+        // A new budget starts over from the full render distance.
+        m_AppliedMemoryBudget = m_MemoryBudget;
+        if (m_MaxLoadDistanceSq != std::numeric_limits<int>::max()) {
+            m_MaxLoadDistanceSq = std::numeric_limits<int>::max();
+            m_LastPlayerChunkPos = glm::ivec3(9999, 0, 9999);
+        }
+    }
+    if (m_MemoryBudget == 0) return;
+
+    WorldMemoryUsage usage = getMemoryUsage();
+    if (usage.total() <= m_MemoryBudget) return;
+
+    // Uploaded geometry and pooled meshes and storage can go without losing anything visible.
+    m_Chunks.forEach([&](Chunk& chunk) {
+        for (Mesh* mesh : { chunk.m_Mesh.get(), chunk.m_TransparentMesh.get() }) {
+            usage.meshCpu -= mesh->getCpuMemoryUsage();
+            mesh->releaseCpuData();
+        }
+        });
+    m_ChunkPool.trimFreeMeshes();
+    m_ChunkPool.trimFreeStorage();
+    usage.pooledMeshGpu = 0;
+    usage.pooledStorage = 0;
+    if (usage.total() <= m_MemoryBudget) return;
+
+    std::vector<std::pair<int, glm::ivec3>> byDistance;
+    m_Chunks.forEach([&](const Chunk& chunk) {
+        glm::ivec3 d = chunk.m_Position - playerChunkPos;
+        byDistance.push_back({ d.x * d.x + d.z * d.z, chunk.m_Position });
+        });
+    std::sort(byDistance.begin(), byDistance.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    size_t evicted = m_EvictedChunks;
+    for (const auto& [distanceSq, pos] : byDistance) {
+        if (usage.total() <= m_MemoryBudget || distanceSq == 0) break;
+        usage -= measureChunk(*m_Chunks.get(pos.x, pos.z));
+        m_Chunks.erase(pos);
+        m_MaxLoadDistanceSq = std::min(m_MaxLoadDistanceSq, distanceSq - 1);
+        m_EvictedChunks++;
+    }
+    if (m_EvictedChunks != evicted) {
+        checkPipelineEverywhere();
+        // Don't let the generators keep working on columns the smaller radius would drop.
+        std::lock_guard<std::mutex> lock(m_GenerationMutex);
+        auto beyond = std::remove_if(m_GenerationRequests.begin(), m_GenerationRequests.end(), [&](const glm::ivec3& pos) {
+            return !isWithinLoadDistance(pos, playerChunkPos);
+            });
+        for (auto it = beyond; it != m_GenerationRequests.end(); ++it) {
+            m_PendingGeneration.erase(*it);
+        }
+        m_GenerationRequests.erase(beyond, m_GenerationRequests.end());
     }
 }
 
@@ -101,10 +295,11 @@ void World::buildDirtyChunks() {
     if (m_DirtyChunks.empty()) return;
 
     for (const auto& pos : m_DirtyChunks) {
-        std::lock_guard<std::mutex> jobLock(m_MeshingJobsMutex);
-        if (m_MeshingJobs.find(pos) == m_MeshingJobs.end()) {
-            m_MeshingJobs.insert(pos);
-            m_MeshingQueue.push(pos);
+        // Chunks that haven't reached meshing get their first mesh from advancePipeline.
+        Chunk* chunk = m_Chunks.get(pos.x, pos.z);
+        if (chunk && chunk->m_Status.load() >= ChunkStatus::Meshing) {
+            uint32_t jobId = chunk->m_LatestMeshJob.fetch_add(1) + 1;
+            m_MeshingQueue.push({ pos, jobId });
         }
     }
     m_DirtyChunks.clear();
@@ -114,30 +309,59 @@ void World::processFinishedMeshes() {
     MeshData finishedMesh;
     while (m_FinishedMeshesQueue.try_pop(finishedMesh)) {
         glm::ivec3 chunkPosition = finishedMesh.chunkPosition;
-        std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-        auto it = m_Chunks.find(chunkPosition);
-        if (it != m_Chunks.end()) {
-            it->second->m_Mesh->vertices = std::move(finishedMesh.vertices);
-            it->second->m_Mesh->indices = std::move(finishedMesh.indices);
-            it->second->m_Mesh->upload();
-            it->second->m_TransparentMesh->vertices = std::move(finishedMesh.transparentVertices);
-            it->second->m_TransparentMesh->indices = std::move(finishedMesh.transparentIndices);
-            it->second->m_TransparentMesh->upload();
+        if (Chunk* chunk = m_Chunks.get(chunkPosition.x, chunkPosition.z)) {
+            auto snapshot = chunk->getSnapshot();
+            if (snapshot->version != finishedMesh.version) {
+                // Edited or relit while meshing. Unless a newer job is already queued,
+                // mesh it again rather than uploading geometry that is already out of date.
+                m_StaleMeshes++;
+                if (chunk->m_LatestMeshJob.load() == finishedMesh.jobId) {
+                    ChunkStatus meshed = ChunkStatus::Meshed;
+                    chunk->m_Status.compare_exchange_strong(meshed, ChunkStatus::Meshing);
+                    std::lock_guard<std::mutex> lock(m_DirtyChunksMutex);
+                    m_DirtyChunks.insert(chunkPosition);
+                }
+                continue;
+            }
+            chunk->m_Status = ChunkStatus::Uploaded;
+            chunk->m_MeshMinY = finishedMesh.minY;
+            chunk->m_MeshMaxY = finishedMesh.maxY;
+            chunk->m_Mesh->vertices = std::move(finishedMesh.vertices);
+            chunk->m_Mesh->indices = std::move(finishedMesh.indices);
+            chunk->m_Mesh->upload();
+            chunk->m_TransparentMesh->vertices = std::move(finishedMesh.transparentVertices);
+            chunk->m_TransparentMesh->indices = std::move(finishedMesh.transparentIndices);
+            chunk->m_TransparentMesh->upload();
         }
-
-        std::lock_guard<std::mutex> jobLock(m_MeshingJobsMutex);
-        m_MeshingJobs.erase(chunkPosition);
     }
 }
 
 void World::mesherLoop() {
+    EpochReclaimer::ReaderSlot& reader = m_Reclaimer.registerReader();
     while (m_IsRunning) {
-        glm::ivec3 jobPos;
-        m_MeshingQueue.wait_and_pop(jobPos);
+        MeshJob job{};
+        m_Reclaimer.goOffline(reader);
+        m_MeshingQueue.wait_and_pop(job);
+        m_Reclaimer.goOnline(reader);
 
         if (!m_IsRunning) break;
 
-        ChunkMeshingData dataProvider(*this, jobPos);
+        const glm::ivec3& jobPos = job.chunkPosition;
+        Chunk* chunk = m_Chunks.get(jobPos.x, jobPos.z);
+        if (!chunk || chunk->m_LatestMeshJob.load() != job.jobId) {
+            m_SupersededMeshJobs++;
+            continue;
+        }
+
+        // Snapshots are immutable, so the lighting thread can keep writing while we copy.
+        auto snapshots = getSnapshotNeighborhood(jobPos);
+        std::array<const ChunkSnapshot*, 9> neighbors;
+        for (int i = 0; i < 9; ++i) {
+            neighbors[i] = snapshots[i].get();
+        }
+        uint32_t version = snapshots[4]->version;
+
+        ChunkMeshingData dataProvider(neighbors, m_LeafQuality.load());
 
         IMesher* mesher = (m_UseGreedyMesher && !m_SmoothLighting)
             ? (IMesher*)m_GreedyMesher.get()
@@ -149,245 +373,130 @@ void World::mesherLoop() {
 
         MeshData meshData;
         meshData.chunkPosition = jobPos;
+        meshData.jobId = job.jobId;
+        meshData.version = version;
+        meshData.minY = CHUNK_HEIGHT;
+        meshData.maxY = 0;
+        for (int sy = 0; sy < SECTION_COUNT; ++sy) {
+            if (dataProvider.isSectionEmpty(sy)) continue;
+            meshData.minY = std::min(meshData.minY, sy * SECTION_HEIGHT);
+            meshData.maxY = (sy + 1) * SECTION_HEIGHT;
+        }
         meshData.vertices = std::move(tempOpaqueMesh.vertices);
         meshData.indices = std::move(tempOpaqueMesh.indices);
         meshData.transparentVertices = std::move(tempTransparentMesh.vertices);
         meshData.transparentIndices = std::move(tempTransparentMesh.indices);
+        ChunkStatus meshing = ChunkStatus::Meshing;
+        chunk->m_Status.compare_exchange_strong(meshing, ChunkStatus::Meshed);
         m_FinishedMeshesQueue.push(std::move(meshData));
     }
+    m_Reclaimer.goOffline(reader);
 }
 
-void World::lightingLoop() {
-    while (m_IsRunning) {
-        LightUpdateJob job;
-        if (m_LightUpdateQueue.try_pop(job)) {
-            processLightUpdates(job);
+void World::generatorLoop() {
+    while (true) {
+        glm::ivec3 pos;
+        std::shared_ptr<const TerrainGenerator> generator;
+        uint32_t revision;
+        {
+            std::unique_lock<std::mutex> lock(m_GenerationMutex);
+            m_GenerationCondition.wait(lock, [this] { return !m_GenerationRequests.empty() || !m_IsRunning; });
+            if (!m_IsRunning) break;
+            pos = m_GenerationRequests.back();
+            m_GenerationRequests.pop_back();
+            generator = m_TerrainGenerator;
+            revision = m_TerrainRevision;
         }
 
-        glm::ivec3 initialPos;
-        if (m_InitialLightQueue.try_pop(initialPos)) {
-            std::shared_ptr<Chunk> chunk;
-            {
-                std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-                auto it = m_Chunks.find(initialPos);
-                if (it != m_Chunks.end()) {
-                    chunk = it->second;
-                }
-            }
-
-            if (chunk) {
-                propagateInitialLight(*chunk);
-
-                const glm::ivec3 offsets[] = { {0,0,0}, {1,0,0}, {-1,0,0}, {0,0,1}, {0,0,-1} };
-                {
-                    std::lock_guard<std::mutex> dirtyLock(m_DirtyChunksMutex);
-                    for (const auto& offset : offsets) {
-                        m_DirtyChunks.insert(initialPos + offset);
-                    }
-                }
-            }
-        }
+        // Generation is a single job with no status of its own until it is done. None of its
+        // steps reads another chunk: border columns come from the generator and neighbours'
+        // trees are replayed from the seed, so a chunk comes out the same whether or not its
+        // neighbours are loaded, and there is nothing to wait for until lighting.
+        auto chunk = m_ChunkPool.acquire(pos.x, pos.y, pos.z);
+        ChunkGeneration generation(pos);
+        generator->shapeTerrain(generation);
+        generator->fillSurface(generation);
+        generator->decorate(generation);
+        chunk->setColumns(generation.blocks);
+        setGenerationStatus(*chunk, ChunkStatus::Decorated);
+        chunk->publishSnapshot();
+        m_GeneratedChunks.push({ std::move(chunk), revision });
     }
 }
 
-void World::propagateInitialLight(Chunk& chunk) {
-    std::queue<LightUpdateNode> sunQueue;
-    std::queue<LightUpdateNode> blockQueue;
-
-    glm::ivec3 chunkWorldPos = chunk.m_Position * glm::ivec3(CHUNK_WIDTH, 0, CHUNK_DEPTH);
-
-    for (int x = 0; x < CHUNK_WIDTH; ++x) {
-        for (int z = 0; z < CHUNK_DEPTH; ++z) {
-            bool skyVisible = true;
-            for (int y = CHUNK_HEIGHT - 1; y >= 0; --y) {
-                BlockID currentBlock = (BlockID)chunk.getBlock(x, y, z);
-                if (skyVisible) {
-                    if (BlockDataManager::isTransparentForLighting(currentBlock)) {
-                        chunk.setSunlight(x, y, z, 15);
-                        sunQueue.push({ chunkWorldPos + glm::ivec3(x, y, z), 15 });
-                    }
-                    else {
-                        chunk.setSunlight(x, y, z, 0);
-                        skyVisible = false;
-                    }
-                }
-                else {
-                    chunk.setSunlight(x, y, z, 0);
-                }
+void World::lightingLoop() {
+    EpochReclaimer::ReaderSlot& reader = m_Reclaimer.registerReader();
+    m_LightScheduler.registerWorker();
+    while (m_IsRunning) {
+        LightJob job;
+        m_Reclaimer.goOffline(reader);
+        if (!m_LightScheduler.acquire(job)) break;
+        m_Reclaimer.goOnline(reader);
 
-                const auto& blockData = BlockDataManager::getData(currentBlock);
-                if (blockData.emissionStrength > 0) {
-                    chunk.setBlockLight(x, y, z, blockData.emissionStrength);
-                    blockQueue.push({ chunkWorldPos + glm::ivec3(x, y, z), blockData.emissionStrength });
-                }
-                else {
-                    chunk.setBlockLight(x, y, z, 0);
+        if (job.type == LightJob::Type::Update) {
+            processLightUpdates(job.updates);
+        }
+        else if (Chunk* chunk = m_Chunks.get(job.chunks.front().x, job.chunks.front().z)) {
+            const glm::ivec3& initialPos = job.chunks.front();
+            propagateInitialLight(*chunk);
+            m_LitChunks.push(initialPos);
+
+            // Light can spill into any of the eight neighbours.
+            std::set<glm::ivec3, ivec3_comp> lit;
+            for (int z = -1; z <= 1; ++z) {
+                for (int x = -1; x <= 1; ++x) {
+                    lit.insert(initialPos + glm::ivec3(x, 0, z));
                 }
             }
-        }
-    }
-
-    while (!sunQueue.empty()) {
-        LightUpdateNode node = sunQueue.front();
-        sunQueue.pop();
-        if (node.level <= 1) continue;
-
-        for (const auto& offset : { glm::ivec3(0,-1,0), glm::ivec3(0,1,0), glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-            glm::ivec3 nPos = node.pos + offset;
-            bool isDownward = offset.y == -1;
-            unsigned char propagatedLight = (isDownward && node.level == 15) ? 15 : node.level - 1;
+            publishSnapshots(lit);
 
-            if (propagatedLight > 0 && BlockDataManager::isTransparentForLighting((BlockID)getBlock(nPos.x, nPos.y, nPos.z)) && getSunlight(nPos.x, nPos.y, nPos.z) < propagatedLight) {
-                setSunlight(nPos.x, nPos.y, nPos.z, propagatedLight);
-                sunQueue.push({ nPos, propagatedLight });
+            const glm::ivec3 offsets[] = { {0,0,0}, {1,0,0}, {-1,0,0}, {0,0,1}, {0,0,-1} };
+            {
+                std::lock_guard<std::mutex> dirtyLock(m_DirtyChunksMutex);
+                for (const auto& offset : offsets) {
+                    m_DirtyChunks.insert(initialPos + offset);
+                }
             }
         }
+        m_LightScheduler.release(job);
     }
+    m_Reclaimer.goOffline(reader);
+}
 
-    while (!blockQueue.empty()) {
-        LightUpdateNode node = blockQueue.front();
-        blockQueue.pop();
-        if (node.level <= 1) continue;
-
-        for (const auto& offset : { glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-            glm::ivec3 nPos = node.pos + offset;
-            if (BlockDataManager::isTransparentForLighting((BlockID)getBlock(nPos.x, nPos.y, nPos.z)) && getBlockLight(nPos.x, nPos.y, nPos.z) < node.level - 1) {
-                setBlockLight(nPos.x, nPos.y, nPos.z, node.level - 1);
-                blockQueue.push({ nPos, (unsigned char)(node.level - 1) });
+std::array<std::shared_ptr<const ChunkSnapshot>, 9> World::getSnapshotNeighborhood(const glm::ivec3& chunkPos) const {
+    std::array<std::shared_ptr<const ChunkSnapshot>, 9> snapshots;
+    int i = 0;
+    for (int z = -1; z <= 1; ++z) {
+        for (int x = -1; x <= 1; ++x) {
+            if (const Chunk* chunk = m_Chunks.get(chunkPos.x + x, chunkPos.z + z)) {
+                snapshots[i] = chunk->getSnapshot();
             }
+            i++;
         }
     }
+    return snapshots;
 }
 
-void World::processLightUpdates(const LightUpdateJob& job) {
-    std::set<glm::ivec3, ivec3_comp> dirtyChunks;
-    const auto& oldData = BlockDataManager::getData(job.oldBlock);
-    const auto& newData = BlockDataManager::getData(job.newBlock);
-
-    {
-        std::queue<LightUpdateNode> removalQueue;
-        std::queue<LightUpdateNode> propagationQueue;
-
-        unsigned char lightAtPos = getBlockLight(job.pos.x, job.pos.y, job.pos.z);
-        unsigned char emissionAtPos = oldData.emissionStrength;
-
-        if (emissionAtPos > 0) {
-            removalQueue.push({ job.pos, emissionAtPos });
-            if (newData.emissionStrength == 0) {
-                setBlockLight(job.pos.x, job.pos.y, job.pos.z, 0);
-            }
-        }
-        else if (!BlockDataManager::isTransparentForLighting(newData.id) && lightAtPos > 0) {
-            removalQueue.push({ job.pos, lightAtPos });
-            setBlockLight(job.pos.x, job.pos.y, job.pos.z, 0);
-        }
-
-        if (newData.emissionStrength > 0) {
-            setBlockLight(job.pos.x, job.pos.y, job.pos.z, newData.emissionStrength);
-            propagationQueue.push({ job.pos, newData.emissionStrength });
-        }
-
-        if (BlockDataManager::isTransparentForLighting(newData.id) && !BlockDataManager::isTransparentForLighting(oldData.id) && oldData.emissionStrength == 0) {
-            for (const auto& offset : { glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-                glm::ivec3 nPos = job.pos + offset;
-                unsigned char light = getBlockLight(nPos.x, nPos.y, nPos.z);
-                if (light > 0) {
-                    propagationQueue.push({ nPos, light });
-                }
-            }
-        }
-
-        while (!removalQueue.empty()) {
-            LightUpdateNode node = removalQueue.front();
-            removalQueue.pop();
-            dirtyChunks.insert({ (int)floor((float)node.pos.x / CHUNK_WIDTH), 0, (int)floor((float)node.pos.z / CHUNK_DEPTH) });
-
-            for (const auto& offset : { glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-                glm::ivec3 nPos = node.pos + offset;
-                unsigned char neighborLevel = getBlockLight(nPos.x, nPos.y, nPos.z);
-                if (neighborLevel != 0) {
-                    if (neighborLevel < node.level) {
-                        setBlockLight(nPos.x, nPos.y, nPos.z, 0);
-                        removalQueue.push({ nPos, neighborLevel });
-                    }
-                    else {
-                        propagationQueue.push({ nPos, neighborLevel });
-                    }
-                }
-            }
-        }
-
-        while (!propagationQueue.empty()) {
-            LightUpdateNode node = propagationQueue.front();
-            propagationQueue.pop();
-            dirtyChunks.insert({ (int)floor((float)node.pos.x / CHUNK_WIDTH), 0, (int)floor((float)node.pos.z / CHUNK_DEPTH) });
-            if (node.level <= 1) continue;
-
-            for (const auto& offset : { glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-                glm::ivec3 nPos = node.pos + offset;
-                if (BlockDataManager::isTransparentForLighting((BlockID)getBlock(nPos.x, nPos.y, nPos.z)) && getBlockLight(nPos.x, nPos.y, nPos.z) < node.level - 1) {
-                    setBlockLight(nPos.x, nPos.y, nPos.z, node.level - 1);
-                    propagationQueue.push({ nPos, (unsigned char)(node.level - 1) });
-                }
-            }
+void World::publishSnapshots(const std::set<glm::ivec3, ivec3_comp>& chunkPositions) {
+    for (const auto& pos : chunkPositions) {
+        if (Chunk* chunk = m_Chunks.get(pos.x, pos.z)) {
+            chunk->publishSnapshot();
         }
     }
+}
 
-    {
-        std::queue<LightUpdateNode> sunRemovalQueue, sunPropagationQueue;
-        unsigned char sunAtPos = getSunlight(job.pos.x, job.pos.y, job.pos.z);
-
-        if (!BlockDataManager::isTransparentForLighting(newData.id) && sunAtPos > 0) {
-            setSunlight(job.pos.x, job.pos.y, job.pos.z, 0);
-            sunRemovalQueue.push({ job.pos, sunAtPos });
-        }
-        else if (BlockDataManager::isTransparentForLighting(newData.id)) {
-            for (const auto& offset : { glm::ivec3(0,-1,0), glm::ivec3(0,1,0), glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-                glm::ivec3 nPos = job.pos + offset;
-                unsigned char light = getSunlight(nPos.x, nPos.y, nPos.z);
-                if (light > 0) sunPropagationQueue.push({ nPos, light });
-            }
-        }
-
-        while (!sunRemovalQueue.empty()) {
-            LightUpdateNode node = sunRemovalQueue.front();
-            sunRemovalQueue.pop();
-            dirtyChunks.insert({ (int)floor((float)node.pos.x / CHUNK_WIDTH), 0, (int)floor((float)node.pos.z / CHUNK_DEPTH) });
-
-            for (const auto& offset : { glm::ivec3(0,-1,0), glm::ivec3(0,1,0), glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-                glm::ivec3 nPos = node.pos + offset;
-                unsigned char neighborLevel = getSunlight(nPos.x, nPos.y, nPos.z);
-                if (neighborLevel > 0) {
-                    if (neighborLevel < node.level || (offset.y == -1 && node.level == 15)) {
-                        setSunlight(nPos.x, nPos.y, nPos.z, 0);
-                        sunRemovalQueue.push({ nPos, neighborLevel });
-                    }
-                    else {
-                        sunPropagationQueue.push({ nPos, neighborLevel });
-                    }
-                }
-            }
-        }
-
-        while (!sunPropagationQueue.empty()) {
-            LightUpdateNode node = sunPropagationQueue.front();
-            sunPropagationQueue.pop();
-            dirtyChunks.insert({ (int)floor((float)node.pos.x / CHUNK_WIDTH), 0, (int)floor((float)node.pos.z / CHUNK_DEPTH) });
-            if (node.level <= 1) continue;
-
-            for (const auto& offset : { glm::ivec3(0,-1,0), glm::ivec3(0,1,0), glm::ivec3(1,0,0), glm::ivec3(-1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,0,-1) }) {
-                glm::ivec3 nPos = node.pos + offset;
-                bool isDownward = offset.y == -1;
-                unsigned char propagatedLight = (isDownward && node.level == 15) ? 15 : node.level - 1;
+void World::propagateInitialLight(Chunk& chunk) {
+    WorldAccessor access(m_Chunks);
+    computeInitialLight(chunk, access);
+}
 
-                if (propagatedLight > 0 && BlockDataManager::isTransparentForLighting((BlockID)getBlock(nPos.x, nPos.y, nPos.z)) && getSunlight(nPos.x, nPos.y, nPos.z) < propagatedLight) {
-                    setSunlight(nPos.x, nPos.y, nPos.z, propagatedLight);
-                    sunPropagationQueue.push({ nPos, propagatedLight });
-                }
-            }
-        }
-    }
+void World::processLightUpdates(const std::vector<LightUpdateJob>& updates) {
+    WorldAccessor access(m_Chunks);
+    // Every edited chunk gets a new snapshot, even if no light changed.
+    std::set<glm::ivec3, ivec3_comp> dirtyChunks;
+    updateLight(updates, access, dirtyChunks);
 
+    publishSnapshots(dirtyChunks);
 
     std::lock_guard<std::mutex> lock(m_DirtyChunksMutex);
     for (const auto& chunkPos : dirtyChunks) {
@@ -400,44 +509,42 @@ void World::processLightUpdates(const LightUpdateJob& job) {
 
 int World::renderOpaque(Shader& shader, const Frustum& frustum) {
     int chunksRendered = 0;
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-    for (auto const& [pos, chunk] : m_Chunks) {
-        glm::vec3 min(pos.x * CHUNK_WIDTH, pos.y * CHUNK_HEIGHT, pos.z * CHUNK_DEPTH);
-        glm::vec3 max = min + glm::vec3(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH);
+    m_Chunks.forEach([&](Chunk& chunk) {
+        if (chunk.m_MeshMinY >= chunk.m_MeshMaxY) return;
+        const glm::ivec3& pos = chunk.m_Position;
+        glm::vec3 min(pos.x * CHUNK_WIDTH, pos.y * CHUNK_HEIGHT + chunk.m_MeshMinY, pos.z * CHUNK_DEPTH);
+        glm::vec3 max(min.x + CHUNK_WIDTH, pos.y * CHUNK_HEIGHT + chunk.m_MeshMaxY, min.z + CHUNK_DEPTH);
 
         if (frustum.isBoxInFrustum(min, max)) {
-            chunk->drawOpaque();
+            chunk.drawOpaque();
             chunksRendered++;
         }
-    }
+        });
     return chunksRendered;
 }
 
 void World::renderTransparent(Shader& shader, const Frustum& frustum) {
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-    for (auto const& [pos, chunk] : m_Chunks) {
-        glm::vec3 min(pos.x * CHUNK_WIDTH, pos.y * CHUNK_HEIGHT, pos.z * CHUNK_DEPTH);
-        glm::vec3 max = min + glm::vec3(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH);
+    m_Chunks.forEach([&](Chunk& chunk) {
+        if (chunk.m_MeshMinY >= chunk.m_MeshMaxY) return;
+        const glm::ivec3& pos = chunk.m_Position;
+        glm::vec3 min(pos.x * CHUNK_WIDTH, pos.y * CHUNK_HEIGHT + chunk.m_MeshMinY, pos.z * CHUNK_DEPTH);
+        glm::vec3 max(min.x + CHUNK_WIDTH, pos.y * CHUNK_HEIGHT + chunk.m_MeshMaxY, min.z + CHUNK_DEPTH);
 
         if (frustum.isBoxInFrustum(min, max)) {
-            chunk->drawTransparent();
+            chunk.drawTransparent();
         }
-    }
+        });
 }
 
 unsigned char World::getBlock(int x, int y, int z) const {
     if (y < 0 || y >= CHUNK_HEIGHT) return 0;
-    int chunkX = static_cast<int>(floor((float)x / CHUNK_WIDTH));
-    int chunkZ = static_cast<int>(floor((float)z / CHUNK_DEPTH));
+    int chunkX = x >> CHUNK_WIDTH_SHIFT;
+    int chunkZ = z >> CHUNK_DEPTH_SHIFT;
 
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-    auto it = m_Chunks.find({ chunkX, 0, chunkZ });
-
-    if (it != m_Chunks.end()) {
-        int localX = (x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
-        int localY = (y % CHUNK_HEIGHT + CHUNK_HEIGHT) % CHUNK_HEIGHT;
-        int localZ = (z % CHUNK_DEPTH + CHUNK_DEPTH) % CHUNK_DEPTH;
-        return it->second->getBlock(localX, localY, localZ);
+    if (Chunk* chunk = m_Chunks.get(chunkX, chunkZ)) {
+        int localX = x & CHUNK_WIDTH_MASK;
+        int localZ = z & CHUNK_DEPTH_MASK;
+        return chunk->getBlock(localX, y, localZ);
     }
     return 0;
 }
@@ -445,116 +552,160 @@ unsigned char World::getBlock(int x, int y, int z) const {
 void World::setBlock(int x, int y, int z, BlockID blockId) {
     if (y < 0 || y >= CHUNK_HEIGHT) return;
 
-    int chunkX = static_cast<int>(floor((float)x / CHUNK_WIDTH));
-    int chunkZ = static_cast<int>(floor((float)z / CHUNK_DEPTH));
+    int chunkX = x >> CHUNK_WIDTH_SHIFT;
+    int chunkZ = z >> CHUNK_DEPTH_SHIFT;
     glm::ivec3 targetChunkPos(chunkX, 0, chunkZ);
 
     BlockID oldBlockId;
+    int oldHeight;
+    int newHeight;
 
     {
-        std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-        auto it = m_Chunks.find(targetChunkPos);
-        if (it == m_Chunks.end()) return;
+        Chunk* chunk = m_Chunks.get(chunkX, chunkZ);
+        if (!chunk) return;
 
-        int localX = (x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
-        int localZ = (z % CHUNK_DEPTH + CHUNK_DEPTH) % CHUNK_DEPTH;
+        int localX = x & CHUNK_WIDTH_MASK;
+        int localZ = z & CHUNK_DEPTH_MASK;
 
-        oldBlockId = (BlockID)it->second->getBlock(localX, y, localZ);
+        oldBlockId = (BlockID)chunk->getBlock(localX, y, localZ);
         if (blockId == oldBlockId) return;
 
-        it->second->setBlock(localX, y, localZ, static_cast<unsigned char>(blockId));
+        // Mesher and lighting threads may be decoding this section right now.
+        oldHeight = chunk->getHeight(localX, localZ);
+        auto oldStorage = chunk->setBlockCopyOnWrite(localX, y, localZ, static_cast<unsigned char>(blockId));
+        m_Reclaimer.retire(std::shared_ptr<PalettedStorage>(std::move(oldStorage)));
+        newHeight = chunk->getHeight(localX, localZ);
     }
 
     {
         std::lock_guard<std::mutex> lock(m_DirtyChunksMutex);
         m_DirtyChunks.insert(targetChunkPos);
-        int localX = (x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
-        int localZ = (z % CHUNK_DEPTH + CHUNK_DEPTH) % CHUNK_DEPTH;
+        int localX = x & CHUNK_WIDTH_MASK;
+        int localZ = z & CHUNK_DEPTH_MASK;
         if (localX == 0) m_DirtyChunks.insert({ chunkX - 1, 0, chunkZ });
         if (localX == CHUNK_WIDTH - 1) m_DirtyChunks.insert({ chunkX + 1, 0, chunkZ });
         if (localZ == 0) m_DirtyChunks.insert({ chunkX, 0, chunkZ - 1 });
         if (localZ == CHUNK_DEPTH - 1) m_DirtyChunks.insert({ chunkX, 0, chunkZ + 1 });
     }
 
-    m_LightUpdateQueue.push({ {x, y, z}, oldBlockId, blockId });
+    m_LightScheduler.pushUpdate({ {x, y, z}, oldBlockId, blockId, oldHeight, newHeight });
+}
+
+int World::getHeight(int x, int z) const {
+    if (Chunk* chunk = m_Chunks.get(x >> CHUNK_WIDTH_SHIFT, z >> CHUNK_DEPTH_SHIFT)) {
+        return chunk->getHeight(x & CHUNK_WIDTH_MASK, z & CHUNK_DEPTH_MASK);
+    }
+    return -1;
 }
 
 unsigned char World::getSunlight(int x, int y, int z) const {
     if (y < 0 || y >= CHUNK_HEIGHT) return 15;
-    int chunkX = static_cast<int>(floor((float)x / CHUNK_WIDTH));
-    int chunkZ = static_cast<int>(floor((float)z / CHUNK_DEPTH));
+    int chunkX = x >> CHUNK_WIDTH_SHIFT;
+    int chunkZ = z >> CHUNK_DEPTH_SHIFT;
 
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-    auto it = m_Chunks.find({ chunkX, 0, chunkZ });
-
-    if (it != m_Chunks.end()) {
-        int localX = (x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
-        int localY = (y % CHUNK_HEIGHT + CHUNK_HEIGHT) % CHUNK_HEIGHT;
-        int localZ = (z % CHUNK_DEPTH + CHUNK_DEPTH) % CHUNK_DEPTH;
-        return it->second->getSunlight(localX, localY, localZ);
+    if (Chunk* chunk = m_Chunks.get(chunkX, chunkZ)) {
+        int localX = x & CHUNK_WIDTH_MASK;
+        int localZ = z & CHUNK_DEPTH_MASK;
+        return chunk->getSunlight(localX, y, localZ);
     }
     return 15;
 }
 
 void World::setSunlight(int x, int y, int z, unsigned char level) {
     if (y < 0 || y >= CHUNK_HEIGHT) return;
-    int chunkX = static_cast<int>(floor((float)x / CHUNK_WIDTH));
-    int chunkZ = static_cast<int>(floor((float)z / CHUNK_DEPTH));
-
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-    auto it = m_Chunks.find({ chunkX, 0, chunkZ });
+    int chunkX = x >> CHUNK_WIDTH_SHIFT;
+    int chunkZ = z >> CHUNK_DEPTH_SHIFT;
 
-    if (it != m_Chunks.end()) {
-        int localX = (x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
-        int localY = (y % CHUNK_HEIGHT + CHUNK_HEIGHT) % CHUNK_HEIGHT;
-        int localZ = (z % CHUNK_DEPTH + CHUNK_DEPTH) % CHUNK_DEPTH;
-        it->second->setSunlight(localX, localY, localZ, level);
+    if (Chunk* chunk = m_Chunks.get(chunkX, chunkZ)) {
+        int localX = x & CHUNK_WIDTH_MASK;
+        int localZ = z & CHUNK_DEPTH_MASK;
+        chunk->setSunlight(localX, y, localZ, level);
     }
 }
 
 unsigned char World::getBlockLight(int x, int y, int z) const {
     if (y < 0 || y >= CHUNK_HEIGHT) return 0;
-    int chunkX = static_cast<int>(floor((float)x / CHUNK_WIDTH));
-    int chunkZ = static_cast<int>(floor((float)z / CHUNK_DEPTH));
-
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-    auto it = m_Chunks.find({ chunkX, 0, chunkZ });
+    int chunkX = x >> CHUNK_WIDTH_SHIFT;
+    int chunkZ = z >> CHUNK_DEPTH_SHIFT;
 
-    if (it != m_Chunks.end()) {
-        int localX = (x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
-        int localY = (y % CHUNK_HEIGHT + CHUNK_HEIGHT) % CHUNK_HEIGHT;
-        int localZ = (z % CHUNK_DEPTH + CHUNK_DEPTH) % CHUNK_DEPTH;
-        return it->second->getBlockLight(localX, localY, localZ);
+    if (Chunk* chunk = m_Chunks.get(chunkX, chunkZ)) {
+        int localX = x & CHUNK_WIDTH_MASK;
+        int localZ = z & CHUNK_DEPTH_MASK;
+        return chunk->getBlockLight(localX, y, localZ);
     }
     return 0;
 }
 
 void World::setBlockLight(int x, int y, int z, unsigned char level) {
     if (y < 0 || y >= CHUNK_HEIGHT) return;
-    int chunkX = static_cast<int>(floor((float)x / CHUNK_WIDTH));
-    int chunkZ = static_cast<int>(floor((float)z / CHUNK_DEPTH));
+    int chunkX = x >> CHUNK_WIDTH_SHIFT;
+    int chunkZ = z >> CHUNK_DEPTH_SHIFT;
 
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
-    auto it = m_Chunks.find({ chunkX, 0, chunkZ });
-
-    if (it != m_Chunks.end()) {
-        int localX = (x % CHUNK_WIDTH + CHUNK_WIDTH) % CHUNK_WIDTH;
-        int localY = (y % CHUNK_HEIGHT + CHUNK_HEIGHT) % CHUNK_HEIGHT;
-        int localZ = (z % CHUNK_DEPTH + CHUNK_DEPTH) % CHUNK_DEPTH;
-        it->second->setBlockLight(localX, localY, localZ, level);
+    if (Chunk* chunk = m_Chunks.get(chunkX, chunkZ)) {
+        int localX = x & CHUNK_WIDTH_MASK;
+        int localZ = z & CHUNK_DEPTH_MASK;
+        chunk->setBlockLight(localX, y, localZ, level);
     }
 }
 
 
 size_t World::getChunkCount() const {
-    std::shared_lock<std::shared_mutex> lock(m_ChunksMutex);
     return m_Chunks.size();
 }
 
-void World::forceReload() {
+WorldMemoryUsage World::measureChunk(const Chunk& chunk) {
+    WorldMemoryUsage usage;
+    usage.blocks = chunk.getBlockMemoryUsage();
+    usage.light = chunk.getLightMemoryUsage();
+    if (auto snapshot = chunk.getSnapshot()) {
+        usage.snapshots = snapshot->getMemoryUsage();
+    }
+    for (const Mesh* mesh : { chunk.m_Mesh.get(), chunk.m_TransparentMesh.get() }) {
+        usage.meshCpu += mesh->getCpuMemoryUsage();
+        usage.meshGpu += mesh->gpuBytes;
+    }
+    return usage;
+}
+
+WorldMemoryUsage World::getMemoryUsage() const {
+    WorldMemoryUsage usage;
+    m_Chunks.forEach([&](const Chunk& chunk) {
+        usage += measureChunk(chunk);
+        });
+    ChunkPool::Stats poolStats = m_ChunkPool.getStats();
+    usage.pooledMeshGpu = poolStats.freeMeshGpuBytes;
+    usage.pooledStorage = poolStats.freeStorageBytes;
+    return usage;
+}
+
+float World::getBudgetLoadRadius() const {
+    if (m_MaxLoadDistanceSq >= m_RenderDistance * m_RenderDistance * 2) {
+        return static_cast<float>(m_RenderDistance);
+    }
+    return std::sqrt(static_cast<float>(m_MaxLoadDistanceSq));
+}
+
+size_t World::getChunkMemoryUsage() const {
+    size_t total = 0;
+    m_Chunks.forEach([&](const Chunk& chunk) {
+        total += chunk.getBlockMemoryUsage() + chunk.getLightMemoryUsage();
+        });
+    return total;
+}
+
+void World::setTerrainLattice(const NoiseLatticeSpacing& lattice) {
+    if (m_TerrainGenerator->getLatticeSpacing() == lattice) return;
+    auto generator = std::make_shared<TerrainGenerator>(1337, lattice);
     {
-        std::unique_lock<std::shared_mutex> lock(m_ChunksMutex);
-        m_Chunks.clear();
+        std::lock_guard<std::mutex> lock(m_GenerationMutex);
+        m_TerrainGenerator = std::move(generator);
+        m_TerrainRevision++;
     }
+    forceReload();
+}
+
+void World::forceReload() {
+    m_Chunks.clear();
+    m_PipelineChecks.clear();
     m_LastPlayerChunkPos = glm::ivec3(9999, 0, 9999);
 }
\ No newline at end of file
@@ -1,18 +1,25 @@
 #pragma once
-#include <map>
+#include <array>
 #include <memory>
 #include <set>
 #include <vector>
 #include <thread>
+#include <limits>
 #include <atomic>
-#include <shared_mutex>
+#include <condition_variable>
 #include <glm/glm.hpp>
 #include "Shader.h"
 #include "Chunk.h"
+#include "ChunkPool.h"
+#include "ChunkTable.h"
+#include "EpochReclaimer.h"
+#include "WorldAccessor.h"
 #include "TerrainGenerator.h"
 #include "ThreadSafeQueue.h"
 #include "Mesher.h"
 #include "Block.h"
+#include "Lighting.h"
+#include "LightScheduler.h"
 #include "GraphicsSettings.h"
 
 struct ivec3_comp {
@@ -23,37 +30,82 @@ struct ivec3_comp {
     }
 };
 
+struct MeshJob {
+    glm::ivec3 chunkPosition;
+    uint32_t jobId;
+};
+
 struct MeshData {
     glm::ivec3 chunkPosition;
+    uint32_t jobId = 0;
+    uint32_t version = 0; // chunk version the mesh was built from
+    int minY = 0;
+    int maxY = CHUNK_HEIGHT;
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
     std::vector<float> transparentVertices;
     std::vector<unsigned int> transparentIndices;
 };
 
-struct LightUpdateNode {
-    glm::ivec3 pos;
-    unsigned char level;
+// Bytes held by the world, by kind. Mesh GPU bytes are what was last uploaded.
+struct WorldMemoryUsage {
+    size_t blocks = 0;
+    size_t light = 0;
+    size_t snapshots = 0;
+    size_t meshCpu = 0;
+    size_t meshGpu = 0;
+    size_t pooledMeshGpu = 0;
+    size_t pooledStorage = 0;
+
+    size_t total() const { return blocks + light + snapshots + meshCpu + meshGpu + pooledMeshGpu + pooledStorage; }
+
+    WorldMemoryUsage& operator+=(const WorldMemoryUsage& other) {
+        blocks += other.blocks;
+        light += other.light;
+        snapshots += other.snapshots;
+        meshCpu += other.meshCpu;
+        meshGpu += other.meshGpu;
+        pooledMeshGpu += other.pooledMeshGpu;
+        pooledStorage += other.pooledStorage;
+        return *this;
+    }
+
+    WorldMemoryUsage& operator-=(const WorldMemoryUsage& other) {
+        blocks -= other.blocks;
+        light -= other.light;
+        snapshots -= other.snapshots;
+        meshCpu -= other.meshCpu;
+        meshGpu -= other.meshGpu;
+        pooledMeshGpu -= other.pooledMeshGpu;
+        pooledStorage -= other.pooledStorage;
+        return *this;
+    }
 };
 
-struct LightUpdateJob {
-    glm::ivec3 pos;
-    BlockID oldBlock;
-    BlockID newBlock;
+// Chunks at each ChunkStatus, indexed by status. Empty counts requested columns no
+// generator has finished yet.
+using ChunkStageCounts = std::array<size_t, CHUNK_STATUS_COUNT>;
+
+// A generated chunk and the terrain generator revision it was generated with.
+struct GeneratedChunk {
+    std::shared_ptr<Chunk> chunk;
+    uint32_t terrainRevision;
 };
 
-class ChunkMeshingData;
 class Frustum;
 
 class World {
-    friend class ChunkMeshingData;
-
 public:
     int m_RenderDistance = 12;
     bool m_UseGreedyMesher = false;
     bool m_UseSunlight = true;
     bool m_SmoothLighting = true;
     std::atomic<LeafQuality> m_LeafQuality{ LeafQuality::Fancy };
+    // Hard cap on getMemoryUsage().total() in bytes, 0 for none. Over budget, CPU copies of
+    // uploaded meshes and pooled meshes go first, then the chunks farthest from the player.
+    size_t m_MemoryBudget = 0;
+    // Generated columns moved into the world per frame; the rest wait for later frames.
+    int m_ChunkInsertsPerFrame = 8;
 
     World();
     ~World();
@@ -66,41 +118,105 @@ public:
     void setSunlight(int x, int y, int z, unsigned char level);
     unsigned char getBlockLight(int x, int y, int z) const;
     void setBlockLight(int x, int y, int z, unsigned char level);
+    // One above the highest sunlight-blocking block of world column (x, z), or -1 if its
+    // chunk isn't loaded. See BasicChunk::getHeight.
+    int getHeight(int x, int z) const;
+    // Cached cursor for code that queries many nearby voxels in a row.
+    WorldAccessor getAccessor() const { return WorldAccessor(m_Chunks); }
 
     size_t getChunkCount() const;
+    size_t getChunkMemoryUsage() const;
+    WorldMemoryUsage getMemoryUsage() const;
+    size_t getEvictedChunkCount() const { return m_EvictedChunks; }
+    // Horizontal distance in chunks that chunks are still loaded to after budget evictions.
+    float getBudgetLoadRadius() const;
+    size_t getPendingReclaimCount() const { return m_Reclaimer.getPendingCount(); }
+    ChunkPool::Stats getChunkPoolStats() const { return m_ChunkPool.getStats(); }
+    size_t getSupersededMeshJobCount() const { return m_SupersededMeshJobs.load(); }
+    size_t getStaleMeshCount() const { return m_StaleMeshes.load(); }
+    size_t getPendingGenerationCount() const { return m_PendingGeneration.size(); }
+    LightScheduler::Stats getLightingStats() const { return m_LightScheduler.getStats(); }
+    ChunkStageCounts getStageCounts() const;
+    const TerrainGenerator& getTerrainGenerator() const { return *m_TerrainGenerator; }
+    // Swaps in a generator sampling noise on the given lattice and regenerates every chunk.
+    void setTerrainLattice(const NoiseLatticeSpacing& lattice);
     void forceReload();
     void stopThreads();
 
 private:
     void loadChunks(const glm::ivec3& playerChunkPos);
+    void insertGeneratedChunks(const glm::ivec3& playerChunkPos);
+    // Starts lighting and first meshing for the checked chunks whose neighbours are ready.
+    void advancePipeline(const glm::ivec3& playerChunkPos);
+    // Whether every neighbour of chunkPos has reached status, or is outside the load area
+    // and won't be coming.
+    bool neighborsReached(const glm::ivec3& chunkPos, ChunkStatus status, const glm::ivec3& playerChunkPos) const;
+    // Queues chunkPos and its eight neighbours for advancePipeline.
+    void checkPipeline(const glm::ivec3& chunkPos);
+    void checkPipelineEverywhere();
+    void setGenerationStatus(Chunk& chunk, ChunkStatus status);
     void buildDirtyChunks();
     void processFinishedMeshes();
+    void enforceMemoryBudget(const glm::ivec3& playerChunkPos);
+    bool isWithinLoadDistance(const glm::ivec3& chunkPos, const glm::ivec3& playerChunkPos) const;
+    static WorldMemoryUsage measureChunk(const Chunk& chunk);
     void mesherLoop();
+    void generatorLoop();
     void lightingLoop();
+    // Snapshots of the chunk at chunkPos and its eight neighbours in [z][x] order.
+    std::array<std::shared_ptr<const ChunkSnapshot>, 9> getSnapshotNeighborhood(const glm::ivec3& chunkPos) const;
+    void publishSnapshots(const std::set<glm::ivec3, ivec3_comp>& chunkPositions);
 
     void propagateInitialLight(Chunk& chunk);
-    void processLightUpdates(const LightUpdateJob& job);
-
-    std::map<glm::ivec3, std::shared_ptr<Chunk>, ivec3_comp> m_Chunks;
-    std::unique_ptr<TerrainGenerator> m_TerrainGenerator;
+    void processLightUpdates(const std::vector<LightUpdateJob>& updates);
+
+    // Declared first so it outlives every chunk still held by the table or the reclaimer.
+    ChunkPool m_ChunkPool;
+    // Chunks are only added and removed on the main thread; mesher and lighting threads
+    // read them without locks and report quiescent states to the reclaimer.
+    EpochReclaimer m_Reclaimer;
+    ChunkTable m_Chunks{ m_Reclaimer };
+    // Replaced only on the main thread, under m_GenerationMutex; generator threads take a
+    // reference along with each request.
+    std::shared_ptr<const TerrainGenerator> m_TerrainGenerator;
+    uint32_t m_TerrainRevision = 0;
     std::unique_ptr<SimpleMesher> m_SimpleMesher;
     std::unique_ptr<GreedyMesher> m_GreedyMesher;
 
     glm::ivec3 m_LastPlayerChunkPos;
+    // Squared distance from the player's chunk beyond which evicted chunks stay unloaded.
+    int m_MaxLoadDistanceSq = std::numeric_limits<int>::max();
+    size_t m_AppliedMemoryBudget = 0;
+    size_t m_EvictedChunks = 0;
     std::set<glm::ivec3, ivec3_comp> m_DirtyChunks;
     std::mutex m_DirtyChunksMutex;
 
     std::vector<std::thread> m_MesherThreads;
-    std::thread m_LightThread;
+    std::vector<std::thread> m_GeneratorThreads;
+    std::vector<std::thread> m_LightThreads;
 
-    ThreadSafeQueue<glm::ivec3> m_MeshingQueue;
+    ThreadSafeQueue<MeshJob> m_MeshingQueue;
     ThreadSafeQueue<MeshData> m_FinishedMeshesQueue;
-    ThreadSafeQueue<LightUpdateJob> m_LightUpdateQueue;
-    ThreadSafeQueue<glm::ivec3> m_InitialLightQueue;
+    LightScheduler m_LightScheduler;
+
+    // Columns waiting for a generator thread, sorted farthest first so workers pop the
+    // nearest. Rebuilt around the player by loadChunks.
+    std::vector<glm::ivec3> m_GenerationRequests;
+    std::mutex m_GenerationMutex;
+    std::condition_variable m_GenerationCondition;
+    // Requested columns that haven't been inserted or dropped yet. Main thread only.
+    std::set<glm::ivec3, ivec3_comp> m_PendingGeneration;
+    ThreadSafeQueue<GeneratedChunk> m_GeneratedChunks;
+    // Generated chunks waiting to be inserted, counted by status until they are inserted or dropped.
+    std::array<std::atomic<size_t>, CHUNK_STATUS_COUNT> m_GenerationStatusCounts{};
+
+    // Chunks whose pipeline stage may be able to advance. Main thread only.
+    std::set<glm::ivec3, ivec3_comp> m_PipelineChecks;
+    // Chunks the lighting thread has finished lighting, for advancePipeline.
+    ThreadSafeQueue<glm::ivec3> m_LitChunks;
 
     std::atomic<bool> m_IsRunning;
-    mutable std::shared_mutex m_ChunksMutex;
 
-    std::set<glm::ivec3, ivec3_comp> m_MeshingJobs;
-    std::mutex m_MeshingJobsMutex;
+    std::atomic<size_t> m_SupersededMeshJobs{ 0 };
+    std::atomic<size_t> m_StaleMeshes{ 0 };
 };
\ No newline at end of file
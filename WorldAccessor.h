@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "Chunk.h"
+#include "ChunkTable.h"
+
+// Cursor for walks over neighbouring voxels, such as lighting floods, raycasts and
+// collision sweeps. It keeps the 3x3 block of chunks around the last chunk it touched, so
+// most steps resolve their chunk with two shifts and an array index instead of a table
+// lookup. Pointers are only valid for as long as the caller may hold chunk pointers, so
+// an accessor lives for one job or one frame and is never stored.
+// Table is anything with a get(chunkX, chunkZ) returning a chunk pointer or nullptr.
+template<typename Table>
+class BasicWorldAccessor {
+public:
+    using ChunkType = std::remove_pointer_t<decltype(std::declval<const Table&>().get(0, 0))>;
+
+    explicit BasicWorldAccessor(const Table& chunks) : m_Chunks(chunks) {}
+
+    unsigned char getBlock(int x, int y, int z) {
+        if (y < 0 || y >= CHUNK_HEIGHT) return 0;
+        ChunkType* chunk = getChunk(x, z);
+        return chunk ? chunk->getBlock(x & CHUNK_WIDTH_MASK, y, z & CHUNK_DEPTH_MASK) : 0;
+    }
+
+    unsigned char getSunlight(int x, int y, int z) {
+        if (y < 0 || y >= CHUNK_HEIGHT) return 15;
+        ChunkType* chunk = getChunk(x, z);
+        return chunk ? chunk->getSunlight(x & CHUNK_WIDTH_MASK, y, z & CHUNK_DEPTH_MASK) : 15;
+    }
+
+    void setSunlight(int x, int y, int z, unsigned char level) {
+        if (y < 0 || y >= CHUNK_HEIGHT) return;
+        if (ChunkType* chunk = getChunk(x, z)) chunk->setSunlight(x & CHUNK_WIDTH_MASK, y, z & CHUNK_DEPTH_MASK, level);
+    }
+
+    unsigned char getBlockLight(int x, int y, int z) {
+        if (y < 0 || y >= CHUNK_HEIGHT) return 0;
+        ChunkType* chunk = getChunk(x, z);
+        return chunk ? chunk->getBlockLight(x & CHUNK_WIDTH_MASK, y, z & CHUNK_DEPTH_MASK) : 0;
+    }
+
+    void setBlockLight(int x, int y, int z, unsigned char level) {
+        if (y < 0 || y >= CHUNK_HEIGHT) return;
+        if (ChunkType* chunk = getChunk(x, z)) chunk->setBlockLight(x & CHUNK_WIDTH_MASK, y, z & CHUNK_DEPTH_MASK, level);
+    }
+
+    // Height of world column (x, z) (see BasicChunk::getHeight); 0, open sky, if not loaded.
+    int getHeight(int x, int z) {
+        ChunkType* chunk = getChunk(x, z);
+        return chunk ? chunk->getHeight(x & CHUNK_WIDTH_MASK, z & CHUNK_DEPTH_MASK) : 0;
+    }
+
+    // Chunk containing world column (x, z), or nullptr if it isn't loaded.
+    ChunkType* getChunk(int x, int z) {
+        int chunkX = x >> CHUNK_WIDTH_SHIFT;
+        int chunkZ = z >> CHUNK_DEPTH_SHIFT;
+        unsigned int dx = static_cast<unsigned int>(chunkX - m_CenterX + 1);
+        unsigned int dz = static_cast<unsigned int>(chunkZ - m_CenterZ + 1);
+        if (dx > 2 || dz > 2) {
+            m_CenterX = chunkX;
+            m_CenterZ = chunkZ;
+            m_Neighbors.fill(nullptr);
+            dx = dz = 1;
+        }
+        // Missing chunks are looked up again next time, in case they have been loaded since.
+        ChunkType*& chunk = m_Neighbors[dx * 3 + dz];
+        if (!chunk) chunk = m_Chunks.get(chunkX, chunkZ);
+        return chunk;
+    }
+
+private:
+    const Table& m_Chunks;
+    int m_CenterX = 0;
+    int m_CenterZ = 0;
+    std::array<ChunkType*, 9> m_Neighbors{};
+};
+
+using WorldAccessor = BasicWorldAccessor<ChunkTable>;
@@ -0,0 +1,190 @@
+#include "WorldPregen.h"
+#include "Chunk.h"
+#include "ChunkPool.h"
+#include "Lighting.h"
+#include "Mesh.h"
+#include "NoiseBatch.h"
+#include "TerrainGenerator.h"
+#include "WorldAccessor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct PregenOptions {
+        int radius = 16;
+        int centerX = 0;
+        int centerZ = 0;
+        int seed = 1337;
+        unsigned int threads = 0; // 0 for one per hardware thread
+    };
+
+    enum PregenStage { STAGE_SHAPE, STAGE_SURFACE, STAGE_DECORATE, STAGE_LIGHT, STAGE_COUNT };
+    const char* const STAGE_NAMES[STAGE_COUNT] = { "shape", "surface", "decorate", "light" };
+
+    bool parseOptions(int argc, char** argv, PregenOptions& options) {
+        for (int i = 0; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--radius") == 0 && i + 1 < argc) {
+                options.radius = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--center") == 0 && i + 2 < argc) {
+                options.centerX = std::atoi(argv[++i]);
+                options.centerZ = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+                options.seed = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                options.threads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+            }
+            else {
+                fprintf(stderr, "Unknown or incomplete option '%s'\n", argv[i]);
+                return false;
+            }
+        }
+        return options.radius >= 0;
+    }
+
+    // The square of chunks being generated, looked up like ChunkTable.
+    class PregenGrid {
+    public:
+        PregenGrid(ChunkPool& pool, const PregenOptions& options)
+            : m_CenterX(options.centerX), m_CenterZ(options.centerZ), m_Radius(options.radius), m_Diameter(2 * options.radius + 1) {
+            m_Chunks.reserve(static_cast<size_t>(m_Diameter) * m_Diameter);
+            for (int x = -m_Radius; x <= m_Radius; ++x) {
+                for (int z = -m_Radius; z <= m_Radius; ++z) {
+                    m_Chunks.push_back(pool.acquire(m_CenterX + x, 0, m_CenterZ + z));
+                }
+            }
+        }
+
+        Chunk* get(int chunkX, int chunkZ) const {
+            int x = chunkX - m_CenterX;
+            int z = chunkZ - m_CenterZ;
+            if (abs(x) > m_Radius || abs(z) > m_Radius) return nullptr;
+            return m_Chunks[static_cast<size_t>(x + m_Radius) * m_Diameter + z + m_Radius].get();
+        }
+
+        const std::vector<std::shared_ptr<Chunk>>& getChunks() const { return m_Chunks; }
+
+    private:
+        int m_CenterX;
+        int m_CenterZ;
+        int m_Radius;
+        int m_Diameter;
+        std::vector<std::shared_ptr<Chunk>> m_Chunks;
+    };
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Calls func(i) for every i below count, spread over threadCount threads.
+    template<typename Func>
+    void runParallel(unsigned int threadCount, size_t count, const Func& func) {
+        std::atomic<size_t> next{ 0 };
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&] {
+                for (size_t i = next++; i < count; i = next++) {
+                    func(i);
+                }
+                });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+int runWorldPregen(int argc, char** argv) {
+    PregenOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "Usage: VoxelPregen [--radius N] [--center X Z] [--seed S] [--threads T]\n");
+        return 1;
+    }
+    unsigned int threadCount = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    ChunkPool pool;
+    PregenGrid grid(pool, options);
+    const auto& chunks = grid.getChunks();
+    const int diameter = 2 * options.radius + 1;
+    printf("Seed %d, %dx%d chunks around chunk (%d, %d), %u threads, %s noise kernel\n", options.seed, diameter, diameter,
+        options.centerX, options.centerZ, threadCount, NoiseBatch::getKernelName(NoiseBatch::getKernel()));
+
+    // Thread time spent in each stage, summed over all chunks.
+    std::atomic<long long> stageNs[STAGE_COUNT] = {};
+    auto timeStage = [&](PregenStage stage, std::chrono::steady_clock::time_point& start) {
+        auto now = std::chrono::steady_clock::now();
+        stageNs[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+        start = now;
+        };
+
+    TerrainGenerator generator(options.seed);
+    auto start = std::chrono::steady_clock::now();
+    runParallel(threadCount, chunks.size(), [&](size_t i) {
+        Chunk& chunk = *chunks[i];
+        ChunkGeneration generation(chunk.m_Position);
+        auto stageStart = std::chrono::steady_clock::now();
+        generator.shapeTerrain(generation);
+        timeStage(STAGE_SHAPE, stageStart);
+        generator.fillSurface(generation);
+        timeStage(STAGE_SURFACE, stageStart);
+        generator.decorate(generation);
+        chunk.setColumns(generation.blocks);
+        timeStage(STAGE_DECORATE, stageStart);
+        });
+    double generateMs = elapsedMs(start);
+
+    // Initial light spills into the eight neighbours, so chunks are lit in nine passes in
+    // which no two chunks being lit at once are closer than three chunks apart.
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 9; ++pass) {
+        std::vector<Chunk*> batch;
+        for (const auto& chunk : chunks) {
+            int px = ((chunk->m_Position.x % 3) + 3) % 3;
+            int pz = ((chunk->m_Position.z % 3) + 3) % 3;
+            if (px * 3 + pz == pass) batch.push_back(chunk.get());
+        }
+        runParallel(threadCount, batch.size(), [&](size_t i) {
+            BasicWorldAccessor<PregenGrid> access(grid);
+            auto stageStart = std::chrono::steady_clock::now();
+            computeInitialLight(*batch[i], access);
+            timeStage(STAGE_LIGHT, stageStart);
+            });
+    }
+    double lightMs = elapsedMs(start);
+
+    size_t blockBytes = 0;
+    size_t lightBytes = 0;
+    for (const auto& chunk : chunks) {
+        blockBytes += chunk->getBlockMemoryUsage();
+        lightBytes += chunk->getLightMemoryUsage();
+    }
+
+    const double totalMs = generateMs + lightMs;
+    printf("%zu chunks in %.1f ms (generate %.1f ms, light %.1f ms), %.1f chunks/sec\n",
+        chunks.size(), totalMs, generateMs, lightMs, chunks.size() * 1000.0 / totalMs);
+
+    long long totalStageNs = 0;
+    for (const auto& ns : stageNs) {
+        totalStageNs += ns.load();
+    }
+    printf("%-10s %14s %8s\n", "stage", "ms/chunk", "share");
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        double ms = stageNs[stage].load() / 1e6;
+        printf("%-10s %14.3f %7.1f%%\n", STAGE_NAMES[stage], ms / chunks.size(),
+            totalStageNs > 0 ? 100.0 * stageNs[stage].load() / totalStageNs : 0.0);
+    }
+    ColumnCache::Stats columnStats = generator.getColumnCacheStats();
+    printf("Memory: %.1f MB blocks, %.1f MB light; column cache %llu hits / %llu misses\n",
+        blockBytes / (1024.0 * 1024.0), lightBytes / (1024.0 * 1024.0),
+        static_cast<unsigned long long>(columnStats.hits), static_cast<unsigned long long>(columnStats.misses));
+    return 0;
+}
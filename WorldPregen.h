@@ -0,0 +1,13 @@
+#pragma once
+
+// Generates and lights a square of chunks around a point on every core, without a window
+// or GL context, and prints chunks per second with a per-stage breakdown. Takes
+// [--radius N] [--center X Z] [--seed S] [--threads T]; returns a process exit code.
+//
+// The VoxelPregen project builds it on its own with VOXEL_HEADLESS defined, linking only
+// the generation, lighting and chunk storage sources, so it also runs on machines without
+// a GPU. VoxelPregen --light-benchmark runs runLightBenchmark instead. On Linux, for example:
+//   g++ -std=c++17 -O2 -DVOXEL_HEADLESS -pthread PregenMain.cpp WorldPregen.cpp
+//       LightBenchmark.cpp Chunk.cpp ChunkPool.cpp ColumnCache.cpp NoiseBatch.cpp
+//       NoiseBatchSse41.cpp NoiseBatchAvx2.cpp PalettedStorage.cpp -o VoxelPregen
+int runWorldPregen(int argc, char** argv);
@@ -1,6 +1,20 @@
 #include "Application.h"
+#include "ChunkTableBenchmark.h"
+#include "LayoutBenchmark.h"
+#include "TerrainBenchmark.h"
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--layout-benchmark") == 0) {
+        return runLayoutBenchmark();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--terrain-benchmark") == 0) {
+        return runTerrainBenchmark();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--chunk-table-benchmark") == 0) {
+        return runChunkTableBenchmark();
+    }
 
-int main() {
     Application app;
     app.run();
     return 0;